@@ -0,0 +1,1114 @@
+// Checks for sgtl-graphs.h: g++ -std=c++14 -O2 -pthread sgtl-graphs-test.cpp && ./a.out
+#include "sgtl-graphs.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    /// Input through a regular file (mmap) or through a pipe (block reads)
+    int openInput(const std::string& text, bool pipeInput) {
+        if (pipeInput) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                throw std::runtime_error("test:: pipe failed");
+            }
+            if (write(fds[1], text.data(), text.size()) != (ssize_t)text.size()) {
+                throw std::runtime_error("test:: write failed");
+            }
+            close(fds[1]);
+            return fds[0];
+        }
+        char name[] = "/tmp/sgtl-graphs-test-XXXXXX";
+        int fd = mkstemp(name);
+        if ((fd < 0) || (write(fd, text.data(), text.size()) != (ssize_t)text.size())) {
+            throw std::runtime_error("test:: temporary file failed");
+        }
+        unlink(name);
+        lseek(fd, 0, SEEK_SET);
+        return fd;
+    }
+
+    enum Outcome { VALUE, NO_DIGITS, OVERFLOW };
+
+    template <class T>
+    Outcome readOne(const std::string& text, bool pipeInput, T& value) {
+        int fd = openInput(text, pipeInput);
+        Outcome outcome = VALUE;
+        {
+            sgtl::io::Reader in(fd);
+            try {
+                value = in.readInt<T>();
+            } catch (std::overflow_error&) {
+                outcome = OVERFLOW;
+            } catch (std::runtime_error&) {
+                outcome = NO_DIGITS;
+            }
+        }
+        close(fd);
+        return outcome;
+    }
+
+    template <class T>
+    void checkValue(const std::string& text, T expected, bool pipeInput) {
+        T value = 0;
+        check((readOne<T>(text, pipeInput, value) == VALUE) && (value == expected), text.c_str());
+    }
+
+    template <class T>
+    void checkFails(const std::string& text, Outcome expected, bool pipeInput) {
+        T value = 0;
+        check(readOne<T>(text, pipeInput, value) == expected, text.c_str());
+    }
+
+    void testReadIntMalformed(bool pipeInput) {
+        checkFails<int>("abc", NO_DIGITS, pipeInput);
+        checkFails<int>("-", NO_DIGITS, pipeInput);
+        checkFails<int>("+x1", NO_DIGITS, pipeInput);
+
+        /// A bad token is skipped, so a hasNext() loop ends
+        int fd = openInput("5 abc 7 - 9", pipeInput);
+        {
+            sgtl::io::Reader in(fd);
+            long long sum = 0;
+            size_t reads = 0;
+            size_t errors = 0;
+            while (in.hasNext() && (reads < 100)) {
+                ++reads;
+                try {
+                    sum += in.readInt<int>();
+                } catch (std::runtime_error&) {
+                    ++errors;
+                }
+            }
+            check((reads == 5) && (errors == 2) && (sum == 21), "io:: readInt loop over malformed tokens");
+        }
+        close(fd);
+    }
+
+    void testReadIntOverflow(bool pipeInput) {
+        checkValue<int8_t>("127", 127, pipeInput);
+        checkValue<int8_t>("-128", -128, pipeInput);
+        checkFails<int8_t>("128", OVERFLOW, pipeInput);
+        checkFails<int8_t>("-129", OVERFLOW, pipeInput);
+
+        checkValue<int>("2147483647", 2147483647, pipeInput);
+        checkValue<int>("-2147483648", -2147483647 - 1, pipeInput);
+        checkFails<int>("2147483648", OVERFLOW, pipeInput);
+        checkFails<int>("-2147483649", OVERFLOW, pipeInput);
+
+        checkValue<int64_t>("9223372036854775807", INT64_MAX, pipeInput);
+        checkValue<int64_t>("-9223372036854775808", INT64_MIN, pipeInput);
+        checkFails<int64_t>("9223372036854775808", OVERFLOW, pipeInput);
+        checkFails<int64_t>("-9223372036854775809", OVERFLOW, pipeInput);
+
+        checkValue<uint64_t>("18446744073709551615", UINT64_MAX, pipeInput);
+        checkValue<uint64_t>("12345678901234567890", 12345678901234567890ULL, pipeInput);
+        checkFails<uint64_t>("18446744073709551616", OVERFLOW, pipeInput);
+        checkFails<uint64_t>("99999999999999999999", OVERFLOW, pipeInput);
+        checkFails<uint64_t>("123456789012345678901234567890", OVERFLOW, pipeInput);
+
+        checkValue<unsigned>("-0", 0, pipeInput);
+        checkFails<unsigned>("-1", OVERFLOW, pipeInput);
+        checkValue<unsigned>("00000000000000000042", 42, pipeInput);
+    }
+
+    /// The reader must hand out what a pipe has delivered so far instead of waiting for its end
+    void testReaderInteractive() {
+        int fds[2];
+        check(pipe(fds) == 0, "pipe for the interactive reader");
+        std::atomic<bool> gotFirst(false);
+        bool waited = false;
+        std::thread writer([&]() {
+            check(write(fds[1], "5\n", 2) == 2, "write to the interactive reader");
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!gotFirst.load() && (std::chrono::steady_clock::now() < deadline)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            waited = !gotFirst.load();
+            /// A number split between two writes is still one token
+            check(write(fds[1], "12", 2) == 2, "write to the interactive reader");
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            check(write(fds[1], "34 -", 4) == 4, "write to the interactive reader");
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            check(write(fds[1], "7", 1) == 1, "write to the interactive reader");
+            close(fds[1]);
+        });
+        {
+            sgtl::io::Reader in(fds[0]);
+            int first = in.readInt<int>();
+            gotFirst.store(true);
+            int second = in.readInt<int>();
+            int third = in.readInt<int>();
+            check((first == 5) && (second == 1234) && (third == -7) && !in.hasNext(), "io:: Reader on a pipe");
+        }
+        writer.join();
+        close(fds[0]);
+        check(!waited, "io:: Reader returns a number before the writer closes the pipe");
+    }
+
+    void testReadEdges(bool pipeInput) {
+        int fd = openInput("1 2 5\n2 3 7\n", pipeInput);
+        {
+            sgtl::io::Reader in(fd);
+            std::vector<sgtl::EdgeFlow> edges;
+            in.readEdges(edges, 2, 1);
+            check((edges.size() == 2) && (edges[0].from() == 0) && (edges[1].to() == 2)
+                  && (edges[1].capacity() == 7), "io:: readEdges with 1-based input");
+        }
+        close(fd);
+
+        const char* bad[] = {"0 1", "1 x", "300 1"};
+        for (const char* text : bad) {
+            fd = openInput(text, pipeInput);
+            {
+                sgtl::io::Reader in(fd);
+                std::vector<sgtl::BasicEdge<uint8_t>> edges;
+                bool thrown = false;
+                try {
+                    in.readEdges(edges, 1, 1);
+                } catch (std::runtime_error&) {
+                    thrown = true;
+                }
+                check(thrown && edges.empty(), text);
+            }
+            close(fd);
+        }
+    }
+
+    void testCheckedCast() {
+        check(sgtl::checkedCast<int32_t>((size_t)5, "") == 5, "checkedCast size_t -> int32_t");
+        check(sgtl::checkedCast<int8_t>(-128, "") == -128, "checkedCast int -> int8_t");
+        check(sgtl::checkedCast<uint64_t>(INT64_MAX, "") == (uint64_t)INT64_MAX, "checkedCast int64_t -> uint64_t");
+        check(sgtl::checkedCast<int64_t>((int8_t)-1, "") == -1, "checkedCast int8_t -> int64_t");
+
+        int thrown = 0;
+        try { sgtl::checkedCast<int32_t>((size_t)1 << 31, ""); } catch (std::overflow_error&) { ++thrown; }
+        try { sgtl::checkedCast<int32_t>(SIZE_MAX, ""); } catch (std::overflow_error&) { ++thrown; }
+        try { sgtl::checkedCast<int8_t>(-129, ""); } catch (std::overflow_error&) { ++thrown; }
+        try { sgtl::checkedCast<unsigned>(-1LL, ""); } catch (std::overflow_error&) { ++thrown; }
+        try { sgtl::checkedCast<uint64_t>(INT64_MIN, ""); } catch (std::overflow_error&) { ++thrown; }
+        try { sgtl::checkedCast<int64_t>(UINT64_MAX, ""); } catch (std::overflow_error&) { ++thrown; }
+        check(thrown == 6, "checkedCast rejects values out of range");
+    }
+
+    /// Network with signed 32-bit vertices, edge ids and capacities
+    typedef sgtl::BasicEdgeFlow<int32_t, int32_t> SignedEdge;
+    typedef sgtl::Network<SignedEdge> SignedNetwork;
+
+    SignedNetwork signedNetwork() {
+        SignedNetwork g(4, 0, 3);
+        g.pushEdge(SignedEdge(0, 1, 3));
+        g.pushEdge(SignedEdge(0, 2, 2));
+        g.pushEdge(SignedEdge(1, 2, 5));
+        g.pushEdge(SignedEdge(1, 3, 2));
+        g.pushEdge(SignedEdge(2, 3, 3));
+        return g;
+    }
+
+    void testSignedIndices() {
+        static_assert(std::is_same<SignedNetwork::vertex_type, int32_t>::value, "signed vertex type");
+        static_assert(std::is_same<SignedNetwork::edge_id_type, int32_t>::value, "signed edge id type");
+
+        SignedNetwork g = signedNetwork();
+        check(g.isVertex(3) && !g.isVertex(4) && !g.isVertex(-1), "Graph::isVertex with signed vertices");
+        check(sgtl::Dinitz<SignedNetwork>::getMaxFlow(g) == 5, "Dinitz on a signed 32-bit network");
+
+        SignedNetwork h = signedNetwork();
+        check(sgtl::PushRelabel<SignedNetwork>::getMaxFlow(h) == 5, "PushRelabel on a signed 32-bit network");
+
+        std::vector<SignedEdge> edges = {SignedEdge(0, 1, 3), SignedEdge(0, 2, 2), SignedEdge(1, 2, 5),
+                                         SignedEdge(1, 3, 2), SignedEdge(2, 3, 3)};
+        SignedNetwork built = SignedNetwork::build(4, 0, 3, edges);
+        check(sgtl::Dinitz<SignedNetwork>::getMaxFlow(built) == 5, "Dinitz on a built signed 32-bit network");
+
+        char name[] = "/tmp/sgtl-graphs-test-XXXXXX";
+        int fd = mkstemp(name);
+        check(fd >= 0, "temporary file for the binary format");
+        close(fd);
+        sgtl::saveBinary(built, name);
+        SignedNetwork loaded = sgtl::loadBinary<SignedNetwork>(name);
+        unlink(name);
+        check((loaded.vertexCount() == 4) && (loaded.edgesCount() == 10), "loadBinary with signed indices");
+    }
+
+    typedef sgtl::Network<sgtl::EdgeFlow> FlowNetwork;
+
+    /// Layered random network: every vertex gets edges only to later ones, so the flow is not trivial
+    FlowNetwork randomNetwork(size_t n, size_t m, sgtl::flow_t maxCapacity, unsigned seed) {
+        std::mt19937 random(seed);
+        FlowNetwork g(n, 0, n - 1);
+        for (size_t i = 0; i < m; ++i) {
+            sgtl::vertex u = random() % (n - 1);
+            sgtl::vertex v = u + 1 + random() % (n - 1 - u);
+            g.pushEdge(sgtl::EdgeFlow(u, v, 1 + random() % maxCapacity));
+        }
+        return g;
+    }
+
+    /// Networks with MAX_FLOW ("infinite") edges, whose maximum flow still fits into flow_t
+    std::vector<FlowNetwork> infiniteNetworks() {
+        std::vector<FlowNetwork> networks;
+        FlowNetwork parallel(3, 0, 2);
+        parallel.pushEdge(sgtl::EdgeFlow(0, 1, sgtl::MAX_FLOW));
+        parallel.pushEdge(sgtl::EdgeFlow(0, 1, sgtl::MAX_FLOW));
+        parallel.pushEdge(sgtl::EdgeFlow(1, 2, 3));
+        networks.push_back(parallel);
+
+        FlowNetwork connectors(6, 0, 5);
+        connectors.pushEdge(sgtl::EdgeFlow(0, 1, sgtl::MAX_FLOW));
+        connectors.pushEdge(sgtl::EdgeFlow(0, 2, sgtl::MAX_FLOW));
+        connectors.pushEdge(sgtl::EdgeFlow(1, 3, 4));
+        connectors.pushEdge(sgtl::EdgeFlow(2, 3, 1));
+        connectors.pushEdge(sgtl::EdgeFlow(2, 4, 6));
+        connectors.pushEdge(sgtl::EdgeFlow(3, 5, sgtl::MAX_FLOW));
+        connectors.pushEdge(sgtl::EdgeFlow(4, 5, sgtl::MAX_FLOW));
+        networks.push_back(connectors);
+
+        FlowNetwork direct(2, 0, 1);
+        direct.pushEdge(sgtl::EdgeFlow(0, 1, sgtl::MAX_FLOW));
+        networks.push_back(direct);
+        return networks;
+    }
+
+    /// The same edges with the current capacities and no flow
+    FlowNetwork withoutFlow(const FlowNetwork& g) {
+        FlowNetwork copy(g.vertexCount(), g.getSource(), g.getTarget());
+        for (size_t id = 0; id < g.edgesCount(); id += 2) {
+            copy.pushEdge(sgtl::EdgeFlow(g.from(id), g.to(id), g.capacity(id)));
+        }
+        return copy;
+    }
+
+    /// Capacities respected, flow conserved everywhere but the source and the target, value as given
+    bool isFlow(const FlowNetwork& g, sgtl::flow_t value) {
+        std::vector<sgtl::flow_t> balance(g.vertexCount(), 0);
+        for (size_t id = 0; id < g.edgesCount(); id += 2) {
+            if ((g.flow(id) < 0) || (g.flow(id) > g.capacity(id))) {
+                return false;
+            }
+            balance[g.from(id)] -= g.flow(id);
+            balance[g.to(id)] += g.flow(id);
+        }
+        for (sgtl::vertex v = 0; v < g.vertexCount(); ++v) {
+            sgtl::flow_t expected = (v == g.getSource()) ? -value : ((v == g.getTarget()) ? value : 0);
+            if (balance[v] != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Edmonds-Karp on a capacity matrix, the reference for the max-flow engines
+    sgtl::flow_t edmondsKarp(const FlowNetwork& g) {
+        size_t n = g.vertexCount();
+        std::vector<std::vector<sgtl::flow_t>> residual(n, std::vector<sgtl::flow_t>(n, 0));
+        for (size_t id = 0; id < g.edgesCount(); id += 2) {
+            residual[g.from(id)][g.to(id)] += g.capacity(id);
+        }
+        sgtl::flow_t flow = 0;
+        while (true) {
+            std::vector<size_t> parent(n, n);
+            std::vector<size_t> queue(1, g.getSource());
+            parent[g.getSource()] = g.getSource();
+            for (size_t head = 0; head < queue.size(); ++head) {
+                for (size_t v = 0; v < n; ++v) {
+                    if ((parent[v] == n) && (residual[queue[head]][v] > 0)) {
+                        parent[v] = queue[head];
+                        queue.push_back(v);
+                    }
+                }
+            }
+            if (parent[g.getTarget()] == n) {
+                return flow;
+            }
+            sgtl::flow_t pushed = sgtl::MAX_FLOW;
+            for (size_t v = g.getTarget(); v != g.getSource(); v = parent[v]) {
+                pushed = std::min(pushed, residual[parent[v]][v]);
+            }
+            for (size_t v = g.getTarget(); v != g.getSource(); v = parent[v]) {
+                residual[parent[v]][v] -= pushed;
+                residual[v][parent[v]] += pushed;
+            }
+            flow += pushed;
+        }
+    }
+
+    void testDinitz() {
+        sgtl::DinitzSolver<FlowNetwork> solver;
+        for (unsigned seed = 0; seed < 20; ++seed) {
+            /// Wide capacity range, where capacity scaling takes a different route to the same value
+            FlowNetwork g = randomNetwork(40, 200, 1000000, seed);
+            sgtl::flow_t expected = edmondsKarp(g);
+            FlowNetwork plain = g;
+            FlowNetwork scaled = g;
+            sgtl::flow_t flow = solver.run(plain);
+            check((flow == expected) && isFlow(plain, flow), "Dinitz equals Edmonds-Karp");
+            flow = solver.run(scaled, true);
+            check((flow == expected) && isFlow(scaled, flow), "Dinitz with capacity scaling equals Edmonds-Karp");
+        }
+
+        /// A path far deeper than a recursive DFS could go on the default stack
+        const size_t length = 1000000;
+        FlowNetwork path(length, 0, length - 1);
+        for (sgtl::vertex v = 0; v + 1 < length; ++v) {
+            path.pushEdge(sgtl::EdgeFlow(v, v + 1, 2 + v % 5));
+        }
+        check(sgtl::Dinitz<FlowNetwork>::getMaxFlow(path) == 2, "Dinitz on a long path");
+    }
+
+    void testSolverReuse() {
+        std::vector<FlowNetwork> networks;
+        std::vector<sgtl::flow_t> expected;
+        for (unsigned seed = 0; seed < 24; ++seed) {
+            /// Sizes vary, so reused buffers have to grow and shrink
+            networks.push_back(randomNetwork(10 + (seed * 7) % 50, 40 + (seed * 31) % 300, 30, seed));
+            expected.push_back(edmondsKarp(networks.back()));
+        }
+
+        sgtl::DinitzSolver<FlowNetwork> dinitz;
+        sgtl::PushRelabelSolver<FlowNetwork> pushRelabel;
+        for (size_t i = 0; i < networks.size(); ++i) {
+            FlowNetwork g = networks[i];
+            FlowNetwork h = networks[i];
+            check(dinitz.run(g) == expected[i], "reused DinitzSolver");
+            check(pushRelabel.run(h) == expected[i], "reused PushRelabelSolver");
+            if (i % 5 == 0) {
+                dinitz.clear();
+                pushRelabel.clear();
+            }
+        }
+
+        sgtl::ThreadPool pool(4);
+        std::vector<FlowNetwork> batch = networks;
+        std::vector<sgtl::flow_t> flows = sgtl::maxFlowBatch(batch, pool);
+        check(flows == expected, "maxFlowBatch with Dinitz");
+        bool valid = true;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            valid = valid && isFlow(batch[i], expected[i]);
+        }
+        check(valid, "maxFlowBatch leaves valid flows");
+
+        batch = networks;
+        std::vector<FlowNetwork*> pointers;
+        for (auto& g : batch) {
+            pointers.push_back(&g);
+        }
+        flows = sgtl::maxFlowBatch<FlowNetwork, sgtl::PushRelabelSolver<FlowNetwork>>(pointers, pool);
+        check(flows == expected, "maxFlowBatch with PushRelabelSolver");
+    }
+
+    void testIncrementalMaxFlow() {
+        for (unsigned seed = 0; seed < 10; ++seed) {
+            std::mt19937 random(seed);
+            FlowNetwork g = randomNetwork(30, 120, 20, seed);
+            sgtl::IncrementalMaxFlow<FlowNetwork> incremental(g);
+            FlowNetwork fresh = withoutFlow(g);
+            check(incremental.getMaxFlow() == sgtl::Dinitz<FlowNetwork>::getMaxFlow(fresh),
+                  "IncrementalMaxFlow equals Dinitz");
+            for (size_t update = 0; update < 30; ++update) {
+                size_t id = 2 * (random() % (g.edgesCount() / 2));
+                switch (random() % 3) {
+                    case 0:
+                        incremental.setCapacity(id, random() % 25);
+                        break;
+                    case 1:
+                        incremental.pushCapacity(id, g.capacity(id) > 3 ? -3 : 3);
+                        break;
+                    default:
+                        incremental.removeEdge(id);
+                }
+                fresh = withoutFlow(g);
+                sgtl::flow_t flow = incremental.getMaxFlow();
+                check((flow == sgtl::Dinitz<FlowNetwork>::getMaxFlow(fresh)) && isFlow(g, flow),
+                      "IncrementalMaxFlow after an update equals Dinitz from scratch");
+            }
+        }
+    }
+
+    void testGomoryHuTree() {
+        sgtl::ThreadPool pool(4);
+        for (unsigned seed = 0; seed < 6; ++seed) {
+            std::mt19937 random(seed);
+            const size_t n = 14;
+            FlowNetwork g(n, 0, n - 1);
+            for (size_t i = 0; i < 30; ++i) {
+                sgtl::vertex u = random() % n;
+                sgtl::vertex v = random() % n;
+                if (u != v) {
+                    g.pushEdge(sgtl::EdgeFlow(u, v, 1 + random() % 9));
+                }
+            }
+            sgtl::GomoryHuTree<FlowNetwork> sequential(g);
+            sgtl::GomoryHuTree<FlowNetwork> parallel(g, pool);
+
+            /// Reference: Dinitz between every pair, every edge taken in both directions
+            bool same = true;
+            for (sgtl::vertex u = 0; u < n; ++u) {
+                for (sgtl::vertex v = u + 1; v < n; ++v) {
+                    FlowNetwork undirected(n, u, v);
+                    for (size_t id = 0; id < g.edgesCount(); id += 2) {
+                        undirected.pushEdge(sgtl::EdgeFlow(g.from(id), g.to(id), g.capacity(id)));
+                        undirected.pushEdge(sgtl::EdgeFlow(g.to(id), g.from(id), g.capacity(id)));
+                    }
+                    sgtl::flow_t cut = sgtl::Dinitz<FlowNetwork>::getMaxFlow(undirected);
+                    same = same && (sequential.minCut(u, v) == cut) && (sequential.minCut(v, u) == cut)
+                           && (parallel.minCut(u, v) == cut);
+                }
+            }
+            check(same, "GomoryHuTree minCut equals Dinitz on every pair");
+
+            size_t roots = 0;
+            bool consistent = true;
+            for (sgtl::vertex v = 0; v < n; ++v) {
+                if (parallel.parent(v) == sgtl::NO_VERTEX) {
+                    ++roots;
+                } else {
+                    consistent = consistent && (parallel.parentCut(v) == parallel.minCut(v, parallel.parent(v)));
+                }
+            }
+            check((roots == 1) && consistent && (parallel.minCut(3, 3) == sgtl::MAX_FLOW), "GomoryHuTree is a tree");
+        }
+    }
+
+    void testPushRelabel() {
+        std::vector<FlowNetwork> networks = infiniteNetworks();
+        sgtl::flow_t expected[] = {3, 11, sgtl::MAX_FLOW};
+        for (size_t i = 0; i < networks.size(); ++i) {
+            FlowNetwork g = networks[i];
+            check(sgtl::Dinitz<FlowNetwork>::getMaxFlow(g) == expected[i], "Dinitz with MAX_FLOW edges");
+            FlowNetwork h = networks[i];
+            check(sgtl::PushRelabel<FlowNetwork>::getMaxFlow(h) == expected[i], "PushRelabel with MAX_FLOW edges");
+        }
+
+        sgtl::PushRelabelSolver<FlowNetwork> solver;
+        for (unsigned seed = 0; seed < 20; ++seed) {
+            FlowNetwork g = randomNetwork(40, 200, 20, seed);
+            FlowNetwork h = g;
+            check(solver.run(h) == sgtl::Dinitz<FlowNetwork>::getMaxFlow(g), "PushRelabel equals Dinitz");
+        }
+    }
+
+    void testParallelPushRelabel() {
+        sgtl::ThreadPool pool(4);
+        std::vector<FlowNetwork> networks = infiniteNetworks();
+        sgtl::flow_t expected[] = {3, 11, sgtl::MAX_FLOW};
+        for (size_t i = 0; i < networks.size(); ++i) {
+            check(sgtl::ParallelPushRelabel<FlowNetwork>::getMaxFlow(networks[i], pool) == expected[i],
+                  "ParallelPushRelabel with MAX_FLOW edges");
+        }
+
+        sgtl::ParallelPushRelabelSolver<FlowNetwork> solver;
+        for (unsigned seed = 0; seed < 20; ++seed) {
+            FlowNetwork g = randomNetwork(40, 200, 20, seed);
+            FlowNetwork h = g;
+            check(solver.run(h, pool) == sgtl::Dinitz<FlowNetwork>::getMaxFlow(g), "ParallelPushRelabel equals Dinitz");
+        }
+
+    }
+
+    typedef sgtl::Network<sgtl::EdgeCostFlow> CostNetwork;
+    const sgtl::cost_t COST_INF = std::numeric_limits<sgtl::cost_t>::max() / 4;
+
+    /// Layered random network with costs in [-5, 20]: edges go only to later vertices, so negative
+    /// costs make no negative cycles
+    CostNetwork randomCostNetwork(size_t n, size_t m, sgtl::flow_t maxCapacity, unsigned seed) {
+        std::mt19937 random(seed);
+        CostNetwork g(n, 0, n - 1);
+        for (size_t i = 0; i < m; ++i) {
+            sgtl::vertex u = random() % (n - 1);
+            sgtl::vertex v = u + 1 + random() % (n - 1 - u);
+            g.pushEdge(sgtl::EdgeCostFlow(u, v, 1 + random() % maxCapacity, (sgtl::cost_t)(random() % 26) - 5));
+        }
+        return g;
+    }
+
+    /// Successive shortest paths by Bellman-Ford on plain arrays, the reference for min-cost flow
+    void referenceMinCostMaxFlow(const CostNetwork& g, sgtl::flow_t& flow, sgtl::cost_t& cost) {
+        std::vector<sgtl::vertex> from, to;
+        std::vector<sgtl::flow_t> residual;
+        std::vector<sgtl::cost_t> price;
+        for (size_t id = 0; id < g.edgesCount(); id += 2) {
+            from.push_back(g.from(id));
+            to.push_back(g.to(id));
+            residual.push_back(g.capacity(id));
+            price.push_back(g.cost(id));
+            from.push_back(g.to(id));
+            to.push_back(g.from(id));
+            residual.push_back(0);
+            price.push_back(-g.cost(id));
+        }
+        size_t n = g.vertexCount();
+        flow = cost = 0;
+        while (true) {
+            std::vector<sgtl::cost_t> distance(n, COST_INF);
+            std::vector<size_t> parent(n, residual.size());
+            distance[g.getSource()] = 0;
+            for (size_t round = 0; round < n; ++round) {
+                for (size_t e = 0; e < residual.size(); ++e) {
+                    if ((residual[e] > 0) && (distance[from[e]] != COST_INF)
+                            && (distance[from[e]] + price[e] < distance[to[e]])) {
+                        distance[to[e]] = distance[from[e]] + price[e];
+                        parent[to[e]] = e;
+                    }
+                }
+            }
+            if (distance[g.getTarget()] == COST_INF) {
+                return;
+            }
+            sgtl::flow_t pushed = sgtl::MAX_FLOW;
+            for (sgtl::vertex v = g.getTarget(); v != g.getSource(); v = from[parent[v]]) {
+                pushed = std::min(pushed, residual[parent[v]]);
+            }
+            for (sgtl::vertex v = g.getTarget(); v != g.getSource(); v = from[parent[v]]) {
+                residual[parent[v]] -= pushed;
+                residual[parent[v] ^ 1] += pushed;
+            }
+            flow += pushed;
+            cost += pushed * distance[g.getTarget()];
+        }
+    }
+
+    /// Cost of the flow on the network, the flow must also be a valid one of the given value
+    bool isCostFlow(const CostNetwork& g, sgtl::flow_t value, sgtl::cost_t cost) {
+        std::vector<sgtl::flow_t> balance(g.vertexCount(), 0);
+        sgtl::cost_t total = 0;
+        for (size_t id = 0; id < g.edgesCount(); id += 2) {
+            if ((g.flow(id) < 0) || (g.flow(id) > g.capacity(id))) {
+                return false;
+            }
+            balance[g.from(id)] -= g.flow(id);
+            balance[g.to(id)] += g.flow(id);
+            total += g.flow(id) * g.cost(id);
+        }
+        for (sgtl::vertex v = 0; v < g.vertexCount(); ++v) {
+            sgtl::flow_t expected = (v == g.getSource()) ? -value : ((v == g.getTarget()) ? value : 0);
+            if (balance[v] != expected) {
+                return false;
+            }
+        }
+        return total == cost;
+    }
+
+    void testMinCostMaxFlow() {
+        for (unsigned seed = 0; seed < 20; ++seed) {
+            CostNetwork g = randomCostNetwork(25, 100, 10, seed);
+            sgtl::flow_t expectedFlow;
+            sgtl::cost_t expectedCost;
+            referenceMinCostMaxFlow(g, expectedFlow, expectedCost);
+            for (int blockingFlow = 0; blockingFlow < 2; ++blockingFlow) {
+                CostNetwork h = g;
+                sgtl::flow_t flow;
+                sgtl::cost_t cost;
+                sgtl::minCostMaxFlow(h, flow, cost, COST_INF, blockingFlow != 0);
+                check((flow == expectedFlow) && (cost == expectedCost) && isCostFlow(h, flow, cost),
+                      blockingFlow ? "minCostMaxFlow with blocking flows" : "minCostMaxFlow one path at a time");
+            }
+        }
+    }
+
+    /// Random network with cycles and costs in [0, 30]
+    CostNetwork randomCyclicCostNetwork(size_t n, size_t m, sgtl::flow_t maxCapacity, unsigned seed) {
+        std::mt19937 random(seed);
+        CostNetwork g(n, 0, n - 1);
+        for (size_t i = 0; i < m; ++i) {
+            g.pushEdge(sgtl::EdgeCostFlow(random() % n, random() % n, 1 + random() % maxCapacity, random() % 31));
+        }
+        return g;
+    }
+
+    /// Both generators, for the engines that must agree with the reference on any network
+    std::vector<CostNetwork> costNetworks() {
+        std::vector<CostNetwork> networks;
+        for (unsigned seed = 0; seed < 15; ++seed) {
+            networks.push_back(randomCostNetwork(25, 100, 10, seed));
+            networks.push_back(randomCyclicCostNetwork(20, 80, 10, seed));
+        }
+        return networks;
+    }
+
+    void testCostScaling() {
+        sgtl::CostScalingSolver<CostNetwork> solver;
+        for (auto& g : costNetworks()) {
+            sgtl::flow_t expectedFlow;
+            sgtl::cost_t expectedCost;
+            referenceMinCostMaxFlow(g, expectedFlow, expectedCost);
+            CostNetwork h = g;
+            sgtl::flow_t flow;
+            sgtl::cost_t cost;
+            solver.run(h, flow, cost);
+            check((flow == expectedFlow) && (cost == expectedCost) && isCostFlow(h, flow, cost),
+                  "CostScalingSolver equals the reference");
+            h = g;
+            sgtl::costScalingMinCostMaxFlow(h, flow, cost);
+            check((flow == expectedFlow) && (cost == expectedCost), "costScalingMinCostMaxFlow equals the reference");
+        }
+    }
+
+    void testNetworkSimplex() {
+        sgtl::NetworkSimplex<CostNetwork> simplex;
+        for (auto& g : costNetworks()) {
+            sgtl::flow_t expectedFlow;
+            sgtl::cost_t expectedCost;
+            referenceMinCostMaxFlow(g, expectedFlow, expectedCost);
+            CostNetwork h = g;
+            sgtl::flow_t flow;
+            sgtl::cost_t cost;
+            simplex.run(h, flow, cost);
+            check((flow == expectedFlow) && (cost == expectedCost) && isCostFlow(h, flow, cost),
+                  "NetworkSimplex min-cost max-flow equals the reference");
+        }
+
+        /// Supplies and demands: the reference routes them from a super source to a super sink
+        for (unsigned seed = 0; seed < 20; ++seed) {
+            std::mt19937 random(seed);
+            CostNetwork g = randomCyclicCostNetwork(15, 60, 8, seed + 100);
+            std::vector<sgtl::flow_t> supply(15, 0);
+            for (size_t i = 0; i < 6; ++i) {
+                sgtl::flow_t amount = 1 + random() % 5;
+                supply[random() % 15] += amount;
+                supply[random() % 15] -= amount;
+            }
+            CostNetwork extended(17, 15, 16);
+            sgtl::flow_t total = 0;
+            for (size_t id = 0; id < g.edgesCount(); id += 2) {
+                extended.pushEdge(sgtl::EdgeCostFlow(g.from(id), g.to(id), g.capacity(id), g.cost(id)));
+            }
+            for (sgtl::vertex v = 0; v < 15; ++v) {
+                if (supply[v] > 0) {
+                    extended.pushEdge(sgtl::EdgeCostFlow(15, v, supply[v], 0));
+                    total += supply[v];
+                } else if (supply[v] < 0) {
+                    extended.pushEdge(sgtl::EdgeCostFlow(v, 16, -supply[v], 0));
+                }
+            }
+            sgtl::flow_t expectedFlow;
+            sgtl::cost_t expectedCost;
+            referenceMinCostMaxFlow(extended, expectedFlow, expectedCost);
+
+            CostNetwork h = g;
+            sgtl::cost_t cost = -1;
+            bool feasible = simplex.run(h, supply, cost);
+            if (expectedFlow == total) {
+                bool balanced = true;
+                std::vector<sgtl::flow_t> balance(15, 0);
+                for (size_t id = 0; id < h.edgesCount(); id += 2) {
+                    balance[h.from(id)] += h.flow(id);
+                    balance[h.to(id)] -= h.flow(id);
+                    balanced = balanced && (h.flow(id) >= 0) && (h.flow(id) <= h.capacity(id));
+                }
+                check(feasible && (cost == expectedCost) && balanced && (balance == supply),
+                      "NetworkSimplex with supplies equals the reference");
+            } else {
+                bool untouched = true;
+                for (size_t id = 0; id < h.edgesCount(); ++id) {
+                    untouched = untouched && (h.flow(id) == 0);
+                }
+                check(!feasible && untouched, "NetworkSimplex rejects supplies that can not be routed");
+            }
+        }
+    }
+
+    typedef sgtl::Graph<sgtl::Edge> PlainGraph;
+    const long long INF = std::numeric_limits<long long>::max() / 4;
+
+    /// Random directed graph with costs in [0, maxCost], cost[id] for edge id
+    PlainGraph randomGraph(size_t n, size_t m, long long maxCost, unsigned seed, std::vector<long long>& cost) {
+        std::mt19937 random(seed);
+        PlainGraph g(n);
+        cost.clear();
+        for (size_t i = 0; i < m; ++i) {
+            g.pushEdge(sgtl::Edge(random() % n, random() % n));
+            cost.push_back(random() % (maxCost + 1));
+        }
+        return g;
+    }
+
+    /// Length of the path by the cheapest edges between its consecutive vertices, INF if it is broken
+    long long pathLength(PlainGraph& g, const std::vector<long long>& cost, const std::vector<sgtl::vertex>& path) {
+        long long length = 0;
+        for (size_t i = 0; i + 1 < path.size(); ++i) {
+            long long best = INF;
+            for (auto id : g.neighbors(path[i])) {
+                if ((g.to(id) == path[i + 1]) && (cost[id] < best)) {
+                    best = cost[id];
+                }
+            }
+            if (best == INF) {
+                return INF;
+            }
+            length += best;
+        }
+        return length;
+    }
+
+    void testDijkstraHeaps() {
+        sgtl::DaryHeap<long long> dary;
+        sgtl::RadixHeap<long long> radix;
+        sgtl::DialHeap<long long> dial(4);     /// narrower than the costs, so the ring has to grow
+        sgtl::ZeroOneHeap<long long> zeroOne;
+        for (unsigned seed = 0; seed < 10; ++seed) {
+            std::vector<long long> cost;
+            PlainGraph g = randomGraph(200, 800, 50, seed, cost);
+            std::vector<long long> binary(cost.size());
+            for (size_t id = 0; id < cost.size(); ++id) {
+                binary[id] = cost[id] % 2;
+            }
+            for (sgtl::vertex s = 0; s < 200; s += 37) {
+                std::vector<long long> expected, shortest;
+                sgtl::dijkstra(g, s, expected, cost, INF);
+                sgtl::dijkstra(g, s, shortest, cost, INF, dary);
+                check(shortest == expected, "dijkstra with DaryHeap");
+                sgtl::dijkstra(g, s, shortest, cost, INF, radix);
+                check(shortest == expected, "dijkstra with RadixHeap");
+                sgtl::dijkstra(g, s, shortest, cost, INF, dial);
+                check(shortest == expected, "dijkstra with DialHeap");
+
+                sgtl::dijkstra(g, s, expected, binary, INF);
+                sgtl::dijkstra(g, s, shortest, binary, INF, zeroOne);
+                check(shortest == expected, "dijkstra with ZeroOneHeap");
+            }
+        }
+    }
+
+    typedef sgtl::EdgeContainer<long long> ValueEdge;
+
+    /// Costs as a functor type rather than a lambda; counts the calls
+    struct EdgeValue {
+        size_t* calls;
+
+        long long operator()(const ValueEdge& e) const {
+            ++*calls;
+            return e.value;
+        }
+    };
+
+    void testCostCallables() {
+        for (unsigned seed = 0; seed < 10; ++seed) {
+            std::vector<long long> cost;
+            PlainGraph plain = randomGraph(150, 600, 40, seed, cost);
+            sgtl::Graph<ValueEdge> g(150);
+            for (size_t id = 0; id < plain.edgesCount(); ++id) {
+                g.pushEdge(ValueEdge(plain.from(id), plain.to(id), cost[id]));
+            }
+            for (sgtl::vertex s = 0; s < 150; s += 29) {
+                std::vector<long long> expected, shortest;
+                sgtl::dijkstra(g, s, expected, cost, INF);
+                sgtl::dijkstra(g, s, shortest, [](const ValueEdge& e) { return e.value; }, INF);
+                check(shortest == expected, "dijkstra with a lambda cost");
+                size_t calls = 0;
+                sgtl::dijkstra(g, s, shortest, EdgeValue{&calls}, INF);
+                check((shortest == expected) && (calls > 0) && (calls <= g.edgesCount()), "dijkstra with a functor cost");
+                sgtl::fordBellman(g, s, shortest, cost, INF);
+                check(shortest == expected, "fordBellman with a cost vector");
+                sgtl::fordBellman(g, s, shortest, [](const ValueEdge& e) { return e.value; }, INF);
+                check(shortest == expected, "fordBellman with a lambda cost");
+            }
+        }
+    }
+
+    /// Cheapest cost of the closed walk through the vertices of cycle, INF if an edge is missing
+    long long cycleCost(PlainGraph& g, const std::vector<long long>& cost, const std::vector<sgtl::vertex>& cycle) {
+        std::vector<sgtl::vertex> walk(cycle);
+        walk.push_back(cycle.front());
+        return pathLength(g, cost, walk);
+    }
+
+    void testNegativeCosts() {
+        sgtl::ThreadPool pool(4);
+        for (unsigned seed = 0; seed < 10; ++seed) {
+            /// Costs cost + p(u) - p(v) for non-negative cost: negative edges, but no negative cycles,
+            /// and dijkstra on cost gives the reference distances
+            std::vector<long long> cost;
+            PlainGraph g = randomGraph(120, 500, 30, seed, cost);
+            std::mt19937 random(seed);
+            std::vector<long long> potential(120);
+            for (auto& p : potential) {
+                p = random() % 40;
+            }
+            std::vector<long long> reduced(cost.size());
+            for (size_t id = 0; id < cost.size(); ++id) {
+                reduced[id] = cost[id] + potential[g.from(id)] - potential[g.to(id)];
+            }
+            for (sgtl::vertex s = 0; s < 120; s += 23) {
+                std::vector<long long> expected, shortest;
+                sgtl::dijkstra(g, s, expected, cost, INF);
+                for (sgtl::vertex v = 0; v < 120; ++v) {
+                    if (expected[v] != INF) {
+                        expected[v] += potential[s] - potential[v];
+                    }
+                }
+                sgtl::fordBellman(g, s, shortest, reduced, INF);
+                check(shortest == expected, "fordBellman with negative costs");
+                check(sgtl::spfa(g, s, shortest, reduced, INF) && (shortest == expected), "spfa with negative costs");
+                check(sgtl::parallelFordBellman(g, s, shortest, reduced, INF, pool) && (shortest == expected),
+                      "parallelFordBellman with negative costs");
+            }
+
+            /// A negative cycle reachable from vertex 0
+            g.pushEdge(sgtl::Edge(0, 1));
+            reduced.push_back(0);
+            g.pushEdge(sgtl::Edge(1, 2));
+            reduced.push_back(-100);
+            g.pushEdge(sgtl::Edge(2, 1));
+            reduced.push_back(-100);
+            std::vector<long long> shortest;
+            std::vector<sgtl::vertex> cycle;
+            check(!sgtl::spfa(g, 0, shortest, reduced, INF, cycle) && !cycle.empty()
+                  && (cycleCost(g, reduced, cycle) < 0), "spfa finds a negative cycle");
+            check(!sgtl::parallelFordBellman(g, 0, shortest, reduced, INF, pool), "parallelFordBellman sees a negative cycle");
+            bool thrown = false;
+            try {
+                sgtl::fordBellman(g, 0, shortest, reduced, INF);
+            } catch (std::runtime_error&) {
+                thrown = true;
+            }
+            check(thrown, "fordBellman throws on a negative cycle");
+        }
+    }
+
+    void testDeltaStepping() {
+        sgtl::ThreadPool pool(4);
+        for (unsigned seed = 0; seed < 8; ++seed) {
+            std::vector<long long> cost;
+            PlainGraph g = randomGraph(300, 1500, 60, seed, cost);
+            sgtl::Graph<ValueEdge> values(300);
+            for (size_t id = 0; id < g.edgesCount(); ++id) {
+                values.pushEdge(ValueEdge(g.from(id), g.to(id), cost[id]));
+            }
+            for (sgtl::vertex s = 0; s < 300; s += 71) {
+                std::vector<long long> expected, shortest;
+                sgtl::dijkstra(g, s, expected, cost, INF);
+                /// 0 picks the width itself; 1 is Dijkstra-like, 1000 is Bellman-Ford-like
+                long long deltas[] = {0, 1, 7, 1000};
+                for (long long delta : deltas) {
+                    sgtl::deltaStepping(g, s, shortest, cost, INF, pool, delta);
+                    check(shortest == expected, "deltaStepping equals dijkstra");
+                }
+                sgtl::deltaStepping(values, s, shortest, [](const ValueEdge& e) { return e.value; }, INF, pool);
+                check(shortest == expected, "deltaStepping with a lambda cost");
+            }
+        }
+    }
+
+    void testShortestPathEngine() {
+        sgtl::ThreadPool pool(4);
+        std::vector<long long> cost;
+        PlainGraph g = randomGraph(250, 1000, 40, 3, cost);
+        sgtl::ShortestPathEngine<PlainGraph, long long> engine(g, INF, pool);
+        sgtl::ShortestPathEngine<PlainGraph, long long, sgtl::DaryHeap<long long>> daryEngine(g, INF, pool);
+        std::mt19937 random(5);
+        /// Several batches on the same engines: the epoch stamps must hide the earlier labels
+        for (size_t batch = 0; batch < 4; ++batch) {
+            std::vector<sgtl::vertex> sources, targets;
+            for (size_t i = 0; i < 20; ++i) {
+                sources.push_back(random() % 250);
+            }
+            for (size_t i = 0; i < 7; ++i) {
+                targets.push_back(random() % 250);
+            }
+            std::vector<std::vector<long long>> expected(sources.size());
+            for (size_t i = 0; i < sources.size(); ++i) {
+                sgtl::dijkstra(g, sources[i], expected[i], cost, INF);
+            }
+
+            std::vector<std::vector<long long>> shortest;
+            engine.query(sources, cost, shortest);
+            check(shortest == expected, "ShortestPathEngine equals dijkstra");
+            daryEngine.query(sources, cost, shortest);
+            check(shortest == expected, "ShortestPathEngine with DaryHeap equals dijkstra");
+
+            std::vector<std::vector<long long>> table;
+            engine.query(sources, targets, cost, table);
+            bool same = table.size() == sources.size();
+            for (size_t i = 0; same && (i < sources.size()); ++i) {
+                same = table[i].size() == targets.size();
+                for (size_t j = 0; same && (j < targets.size()); ++j) {
+                    same = table[i][j] == expected[i][targets[j]];
+                }
+            }
+            check(same, "ShortestPathEngine distance table equals dijkstra");
+        }
+    }
+
+    void testPointToPointSearch() {
+        std::vector<long long> cost;
+        PlainGraph g = randomGraph(300, 1200, 50, 7, cost);
+        sgtl::PointToPointSearch<PlainGraph, long long> search(g, INF);
+        std::mt19937 random(11);
+        std::vector<long long> shortest;
+        std::vector<sgtl::vertex> path;
+        for (size_t query = 0; query < 100; ++query) {
+            sgtl::vertex s = random() % 300;
+            sgtl::vertex t = random() % 300;
+            sgtl::dijkstra(g, s, shortest, cost, INF);
+
+            long long length = search.bidirectional(s, t, cost, path);
+            bool ok = (length == shortest[t]);
+            if (length != INF) {
+                ok = ok && (path.front() == s) && (path.back() == t) && (pathLength(g, cost, path) == length);
+            } else {
+                ok = ok && path.empty();
+            }
+            check(ok, "PointToPointSearch::bidirectional equals dijkstra");
+
+            length = search.astar(s, t, cost, [](sgtl::vertex) { return 0LL; }, path);
+            check((length == shortest[t]) && ((length == INF) || (pathLength(g, cost, path) == length)),
+                  "PointToPointSearch::astar equals dijkstra");
+        }
+
+        /// Grid with unit costs: the Manhattan distance is a consistent heuristic
+        const size_t side = 30;
+        PlainGraph grid(side * side);
+        for (size_t v = 0; v < side * side; ++v) {
+            if (v % side + 1 < side) {
+                grid.pushEdge(sgtl::Edge(v, v + 1));
+                grid.pushEdge(sgtl::Edge(v + 1, v));
+            }
+            if (v + side < side * side) {
+                grid.pushEdge(sgtl::Edge(v, v + side));
+                grid.pushEdge(sgtl::Edge(v + side, v));
+            }
+        }
+        std::vector<long long> unit(grid.edgesCount(), 1);
+        sgtl::PointToPointSearch<PlainGraph, long long> gridSearch(grid, INF);
+        for (size_t query = 0; query < 50; ++query) {
+            sgtl::vertex s = random() % (side * side);
+            sgtl::vertex t = random() % (side * side);
+            long long manhattan = std::abs((long long)(s % side) - (long long)(t % side))
+                                  + std::abs((long long)(s / side) - (long long)(t / side));
+            auto heuristic = [t, side](sgtl::vertex v) {
+                return std::abs((long long)(v % side) - (long long)(t % side))
+                       + std::abs((long long)(v / side) - (long long)(t / side));
+            };
+            check(gridSearch.astar(s, t, unit, heuristic, path) == manhattan, "PointToPointSearch::astar on a grid");
+            check(sgtl::shortestPath(grid, s, t, unit, INF, path) == manhattan, "shortestPath on a grid");
+        }
+    }
+
+    /// Kuhn's augmenting paths, the reference for BipartiteMatching
+    bool kuhn(const std::vector<std::vector<sgtl::vertex>>& adjacent, sgtl::vertex u, std::vector<char>& used,
+              std::vector<sgtl::vertex>& mate) {
+        for (auto v : adjacent[u]) {
+            if (!used[v]) {
+                used[v] = 1;
+                if ((mate[v] == sgtl::NO_VERTEX) || kuhn(adjacent, mate[v], used, mate)) {
+                    mate[v] = u;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void testBipartiteMatching() {
+        for (unsigned seed = 0; seed < 30; ++seed) {
+            std::mt19937 random(seed);
+            size_t left = 1 + random() % 60;
+            size_t right = 1 + random() % 60;
+            size_t m = random() % (3 * (left + right));
+            std::vector<std::pair<sgtl::vertex, sgtl::vertex>> edges;
+            std::vector<std::vector<sgtl::vertex>> adjacent(left);
+            for (size_t i = 0; i < m; ++i) {
+                sgtl::vertex u = random() % left;
+                sgtl::vertex v = random() % right;
+                edges.push_back(std::make_pair(u, v));
+                adjacent[u].push_back(v);
+            }
+            std::vector<sgtl::vertex> mate(right, sgtl::NO_VERTEX);
+            size_t expected = 0;
+            for (sgtl::vertex u = 0; u < left; ++u) {
+                std::vector<char> used(right, 0);
+                expected += kuhn(adjacent, u, used, mate);
+            }
+
+            /// Half of the edges first, then the rest, so run() continues from a matching
+            sgtl::BipartiteMatching matching(left, right);
+            for (size_t i = 0; i < edges.size() / 2; ++i) {
+                matching.pushEdge(edges[i].first, edges[i].second);
+            }
+            matching.run();
+            for (size_t i = edges.size() / 2; i < edges.size(); ++i) {
+                matching.pushEdge(edges[i].first, edges[i].second);
+            }
+            check(matching.run() == expected, "BipartiteMatching equals Kuhn");
+
+            bool consistent = true;
+            size_t matched = 0;
+            for (sgtl::vertex u = 0; u < left; ++u) {
+                sgtl::vertex v = matching.mateOfLeft(u);
+                if (v != sgtl::NO_VERTEX) {
+                    ++matched;
+                    consistent = consistent && (matching.mateOfRight(v) == u)
+                                 && (std::find(adjacent[u].begin(), adjacent[u].end(), v) != adjacent[u].end());
+                }
+            }
+            check(consistent && (matched == expected), "BipartiteMatching mates form a matching");
+
+            std::vector<sgtl::vertex> coverLeft, coverRight;
+            matching.minVertexCover(coverLeft, coverRight);
+            std::vector<char> inLeft(left, 0), inRight(right, 0);
+            for (auto u : coverLeft) {
+                inLeft[u] = 1;
+            }
+            for (auto v : coverRight) {
+                inRight[v] = 1;
+            }
+            bool covered = true;
+            for (auto& e : edges) {
+                covered = covered && (inLeft[e.first] || inRight[e.second]);
+            }
+            check(covered && (coverLeft.size() + coverRight.size() == expected), "Konig cover has the matching size");
+
+            std::vector<sgtl::vertex> freeLeft, freeRight;
+            matching.maxIndependentSet(freeLeft, freeRight);
+            check(freeLeft.size() + freeRight.size() == left + right - expected, "maxIndependentSet is the complement");
+        }
+    }
+}
+
+int main() {
+    for (int pipeInput = 0; pipeInput < 2; ++pipeInput) {
+        testReadIntMalformed(pipeInput != 0);
+        testReadIntOverflow(pipeInput != 0);
+        testReadEdges(pipeInput != 0);
+    }
+    testReaderInteractive();
+    testCheckedCast();
+    testSignedIndices();
+    testDinitz();
+    testSolverReuse();
+    testIncrementalMaxFlow();
+    testGomoryHuTree();
+    testPushRelabel();
+    testParallelPushRelabel();
+    testMinCostMaxFlow();
+    testCostScaling();
+    testNetworkSimplex();
+    testDijkstraHeaps();
+    testCostCallables();
+    testNegativeCosts();
+    testDeltaStepping();
+    testShortestPathEngine();
+    testPointToPointSearch();
+    testBipartiteMatching();
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed\n";
+    return EXIT_SUCCESS;
+}
@@ -3,8 +3,15 @@
 #include <exception>
 #include <stdexcept>
 #include <climits>
+#include <cstdint>
+#include <limits>
 #include <functional>
 #include <algorithm>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 /// 09 October 2016
 
@@ -18,706 +25,3888 @@ namespace sgtl {
     typedef long long cost_t;
 
     const flow_t MAX_FLOW = LLONG_MAX;
+    const vertex NO_VERTEX = std::numeric_limits<vertex>::max();
 
-    class Edge {
-    public:
-        Edge(vertex from, vertex to) : from_(from), to_(to) {
+    /// value < 0 without a tautological comparison for unsigned types
+    template <class Integer>
+    bool isNegative(Integer value, std::true_type /* signed */) {
+        return value < 0;
+    }
+
+    template <class Integer>
+    bool isNegative(Integer, std::false_type /* signed */) {
+        return false;
+    }
+
+    template <class Integer>
+    bool isNegative(Integer value) {
+        return isNegative(value, std::is_signed<Integer>());
+    }
+
+    /// Narrows a value to a compact index/capacity type, throws if it does not fit;
+    /// the bounds are compared in intmax_t/uintmax_t, so any signedness mix works
+    template <class T, class Wide>
+    T checkedCast(Wide value, const char* message) {
+        static_assert(std::is_integral<T>::value && std::is_integral<Wide>::value, "checkedCast:: integer types only");
+        if (isNegative(value)
+                ? (!std::is_signed<T>::value || ((intmax_t)value < (intmax_t)std::numeric_limits<T>::min()))
+                : ((uintmax_t)value > (uintmax_t)std::numeric_limits<T>::max())) {
+            throw std::overflow_error(message);
         }
-        vertex from() const {
-            return from_;
+        return (T)value;
+    }
+
+    /// Runs f(t) for every t in [0, threads), t = 0 on the calling thread
+    template <class F>
+    void parallelRun(size_t threads, F f) {
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; ++t) {
+            workers.push_back(std::thread(f, t));
         }
-        vertex to() const {
-            return to_;
+        f(0);
+        for (size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+        }
+    }
+
+    /// All per-edge values in their widest types, used to move edges in and out of column storage
+    struct EdgeFields {
+        size_t from;
+        size_t to;
+        flow_t capacity;
+        flow_t flow;
+        cost_t cost;
+        int mark;
+
+        EdgeFields() : from(0), to(0), capacity(0), flow(0), cost(0), mark(0) {
         }
-    private:
-        vertex from_;
-        vertex to_;
     };
 
-    template <class T>
-    class EdgeContainer : public Edge {
+    /// Persistent workers for fork-join loops (successor of task_5/thread_pool.h, without busy waiting).
+    /// run(f) calls f(t) for every t in [0, size()), t = 0 on the calling thread, and waits for all;
+    /// the first exception thrown by f is rethrown. Jobs must not call run() of the same pool.
+    class ThreadPool {
     public:
-        EdgeContainer(vertex from, vertex to) : Edge(from, to) {
+        explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
+            : job_(NULL), generation_(0), pending_(0), working_(true) {
+            for (size_t t = 1; t < threads; ++t) {
+                workers_.push_back(std::thread([this, t]() { loop_(t); }));
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                working_ = false;
+            }
+            start_.notify_all();
+            for (size_t t = 0; t < workers_.size(); ++t) {
+                workers_[t].join();
+            }
+        }
+
+        size_t size() const {
+            return workers_.size() + 1;
+        }
+
+        template <class F>
+        void run(F f) {
+            std::function<void(size_t)> job(f);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job_ = &job;
+                pending_ = workers_.size();
+                error_ = std::exception_ptr();
+                ++generation_;
+            }
+            start_.notify_all();
+            try {
+                job(0);
+            } catch (...) {
+                setError_(std::current_exception());
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            finish_.wait(lock, [this]() { return pending_ == 0; });
+            job_ = NULL;
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
         }
-        EdgeContainer(vertex from, vertex to, T value) : Edge(from, to), value(value) {
+
+        /// Calls f(i, t) for every i in [0, count), t is the worker index;
+        /// indices are handed out in chunks on demand, so uneven work is balanced
+        template <class F>
+        void parallelFor(size_t count, F f, size_t chunk = 256) {
+            if ((count <= chunk) || (size() == 1)) {
+                for (size_t i = 0; i < count; ++i) {
+                    f(i, (size_t)0);
+                }
+                return;
+            }
+            std::atomic<size_t> next(0);
+            run([&](size_t t) {
+                for (size_t first = next.fetch_add(chunk); first < count; first = next.fetch_add(chunk)) {
+                    for (size_t i = first; i < std::min(count, first + chunk); ++i) {
+                        f(i, t);
+                    }
+                }
+            });
         }
-        T value;
+
     private:
-        vertex from_;
-        vertex to_;
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable start_;
+        std::condition_variable finish_;
+        std::function<void(size_t)>* job_;
+        size_t generation_;
+        size_t pending_;
+        bool working_;
+        std::exception_ptr error_;
+
+        void loop_(size_t t) {
+            size_t seen = 0;
+            while (true) {
+                std::function<void(size_t)>* job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    start_.wait(lock, [&]() { return !working_ || (generation_ != seen); });
+                    if (!working_) {
+                        return;
+                    }
+                    seen = generation_;
+                    job = job_;
+                }
+                try {
+                    (*job)(t);
+                } catch (...) {
+                    setError_(std::current_exception());
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) {
+                    finish_.notify_one();
+                }
+            }
+        }
+
+        void setError_(std::exception_ptr error) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = error;
+            }
+        }
     };
 
-    class EdgeFlow : public Edge {
+    /// V - vertex index type, Id - edge index type.
+    /// Bottom of every edge type, properties are stacked on top of it by policies (see EdgeWith).
+    template <class V = vertex, class Id = V>
+    class BasicEdge {
     public:
-        EdgeFlow(vertex from, vertex to, flow_t capacity)
-            : Edge(from, to), capacity_(capacity), flow_(0) {
+        typedef V vertex_type;
+        typedef Id edge_id_type;
+
+        static const bool hasFlow = false;
+        static const bool hasCost = false;
+        static const bool hasMark = false;
+        static const bool hasValue = false;
+
+        BasicEdge(V from, V to) : from_(from), to_(to) {
         }
-        flow_t capacity() const {
-            return capacity_;
+        explicit BasicEdge(const EdgeFields& fields) : from_((V)fields.from), to_((V)fields.to) {
         }
-        flow_t flow() const {
-            return flow_;
+        V from() const {
+            return from_;
         }
-        flow_t pushFlow(flow_t flow) {
-            flow_t addition = std::min(flow, capacity_ - flow_);
-            flow_ += addition;
-            return addition;
+        V to() const {
+            return to_;
         }
-        void pushCapacity(flow_t flow) {
-            capacity_ += flow;
+        void setEnds(V from, V to) {
+            from_ = from;
+            to_ = to;
         }
-        bool unsaturated() const {
-            return flow_ < capacity_;
+
+        /// Turns the edge into its back edge, every policy reverses its own part
+        void makeBackEdge() {
+            std::swap(from_, to_);
         }
-        flow_t residualCapacity() const {
-            return capacity_ - flow_;
+        void saveFields(EdgeFields& fields) const {
+            fields.from = from_;
+            fields.to = to_;
         }
-
     private:
-        flow_t capacity_;
-        flow_t flow_;
+        V from_;
+        V to_;
+    };
+
+    /// Edge property policies. Policy::Layer<Base> adds the property on top of Base.
+    /// Constructor arguments follow from and to in the order the policies are listed;
+    /// policies with an optional argument (Mark, Value) go last.
+
+    /// F - capacity type, must be signed (back edges carry negative flow).
+    /// Capacities are passed as flow_t and checked to fit into F.
+    template <class F = flow_t>
+    struct Capacity {
+        static_assert(std::is_signed<F>::value, "EdgeFlow:: capacity type must be signed");
+
+        template <class Base>
+        class Layer : public Base {
+        public:
+            typedef typename Base::vertex_type vertex_type;
+            typedef F flow_type;
+            static const bool hasFlow = true;
+
+            template <class... Rest>
+            Layer(vertex_type from, vertex_type to, flow_t capacity, Rest... rest)
+                : Base(from, to, rest...), capacity_(checkedCast<F>(capacity, "EdgeFlow:: capacity overflow")),
+                  flow_(0) {
+            }
+            explicit Layer(const EdgeFields& fields)
+                : Base(fields), capacity_(checkedCast<F>(fields.capacity, "EdgeFlow:: capacity overflow")),
+                  flow_(checkedCast<F>(fields.flow, "EdgeFlow:: flow overflow")) {
+            }
+            F capacity() const {
+                return capacity_;
+            }
+            F flow() const {
+                return flow_;
+            }
+            flow_t pushFlow(flow_t flow) {
+                flow_t addition = std::min(flow, (flow_t)capacity_ - flow_);
+                flow_ += (F)addition;
+                return addition;
+            }
+            void pushCapacity(flow_t flow) {
+                capacity_ = checkedCast<F>(capacity_ + flow, "EdgeFlow:: capacity overflow");
+            }
+            bool unsaturated() const {
+                return flow_ < capacity_;
+            }
+            F residualCapacity() const {
+                return capacity_ - flow_;
+            }
+
+            /// Back edge has zero capacity and the opposite flow
+            void makeBackEdge() {
+                Base::makeBackEdge();
+                capacity_ = 0;
+                flow_ = -flow_;
+            }
+            void saveFields(EdgeFields& fields) const {
+                Base::saveFields(fields);
+                fields.capacity = capacity_;
+                fields.flow = flow_;
+            }
+
+        private:
+            F capacity_;
+            F flow_;
+        };
+    };
+
+    /// C - cost type, back edges get the negated cost
+    template <class C = cost_t>
+    struct Cost {
+        template <class Base>
+        class Layer : public Base {
+        public:
+            typedef typename Base::vertex_type vertex_type;
+            typedef C cost_type;
+            static const bool hasCost = true;
+
+            template <class... Rest>
+            Layer(vertex_type from, vertex_type to, cost_t cost, Rest... rest)
+                : Base(from, to, rest...), cost_(checkedCast<C>(cost, "EdgeCostFlow:: cost overflow")) {
+            }
+            explicit Layer(const EdgeFields& fields)
+                : Base(fields), cost_(checkedCast<C>(fields.cost, "EdgeCostFlow:: cost overflow")) {
+            }
+            C cost() const {
+                return cost_;
+            }
+
+            void makeBackEdge() {
+                Base::makeBackEdge();
+                cost_ = checkedCast<C>(0 - (cost_t)cost_, "EdgeCostFlow:: cost overflow");
+            }
+            void saveFields(EdgeFields& fields) const {
+                Base::saveFields(fields);
+                fields.cost = cost_;
+            }
+
+        private:
+            C cost_;
+        };
+    };
+
+    /// Integer mark for algorithms (decompositions, matchings), 0 by default and on back edges
+    struct Mark {
+        template <class Base>
+        class Layer : public Base {
+        public:
+            typedef typename Base::vertex_type vertex_type;
+            static const bool hasMark = true;
+
+            Layer(vertex_type from, vertex_type to)
+                : Base(from, to), mark(0) {
+            }
+            Layer(vertex_type from, vertex_type to, int mark)
+                : Base(from, to), mark(mark) {
+            }
+            explicit Layer(const EdgeFields& fields)
+                : Base(fields), mark(fields.mark) {
+            }
+
+            void makeBackEdge() {
+                Base::makeBackEdge();
+                mark = 0;
+            }
+            void saveFields(EdgeFields& fields) const {
+                Base::saveFields(fields);
+                fields.mark = mark;
+            }
+
+            int mark;
+        };
+    };
+
+    /// Arbitrary user value, copied to back edges; not kept by column storage
+    template <class T>
+    struct Value {
+        template <class Base>
+        class Layer : public Base {
+        public:
+            typedef typename Base::vertex_type vertex_type;
+            typedef T value_type;
+            static const bool hasValue = true;
+
+            Layer(vertex_type from, vertex_type to)
+                : Base(from, to), value() {
+            }
+            Layer(vertex_type from, vertex_type to, T value)
+                : Base(from, to), value(value) {
+            }
+            explicit Layer(const EdgeFields& fields)
+                : Base(fields), value() {
+            }
+
+            T value;
+        };
+    };
+
+    template <class Base, class... Policies>
+    struct ComposeEdge_ {
+        typedef Base type;
+    };
+    template <class Base, class P, class... Rest>
+    struct ComposeEdge_<Base, P, Rest...> {
+        typedef typename P::template Layer<typename ComposeEdge_<Base, Rest...>::type> type;
     };
 
-    class EdgeCostFlow : public EdgeFlow {
+    /// Edge type with the given properties, e.g. EdgeWith<Capacity<int>, Cost<>, Mark>
+    /// is built as EdgeWith(from, to, capacity, cost[, mark]).
+    /// Everything is resolved at compile time: no virtual calls, no per-edge overhead.
+    template <class V, class Id, class... Policies>
+    using BasicEdgeWith = typename ComposeEdge_<BasicEdge<V, Id>, Policies...>::type;
+
+    template <class... Policies>
+    using EdgeWith = BasicEdgeWith<vertex, vertex, Policies...>;
+
+    template <class T, class V = vertex, class Id = V>
+    using EdgeContainer = BasicEdgeWith<V, Id, Value<T>>;
+
+    template <class F = flow_t, class V = vertex, class Id = V>
+    using BasicEdgeFlow = BasicEdgeWith<V, Id, Capacity<F>>;
+
+    template <class F = flow_t, class C = cost_t, class V = vertex, class Id = V>
+    using BasicEdgeCostFlow = BasicEdgeWith<V, Id, Capacity<F>, Cost<C>>;
+
+    template <class F = flow_t, class V = vertex, class Id = V>
+    using BasicEdgeFlowMarked = BasicEdgeWith<V, Id, Capacity<F>, Mark>;
+
+    template <class F = flow_t, class C = cost_t, class V = vertex, class Id = V>
+    using BasicEdgeCostFlowMarked = BasicEdgeWith<V, Id, Capacity<F>, Cost<C>, Mark>;
+
+    typedef BasicEdge<> Edge;
+    typedef BasicEdgeFlow<> EdgeFlow;
+    typedef BasicEdgeCostFlow<> EdgeCostFlow;
+    typedef BasicEdgeFlowMarked<> EdgeFlowMarked;
+    typedef BasicEdgeCostFlowMarked<> EdgeCostFlowMarked;
+
+    /// Back edge of a network edge: swapped ends, zero capacity, negated cost
+    template <class E>
+    E backEdge(const E& e) {
+        E back(e);
+        back.makeBackEdge();
+        return back;
+    }
+
+    /// Cost type of an edge, cost_t for edges without cost
+    template <class E, bool = E::hasCost>
+    struct EdgeCostType_ {
+        typedef cost_t type;
+    };
+    template <class E>
+    struct EdgeCostType_<E, true> {
+        typedef typename E::cost_type type;
+    };
+
+    /// Default edge storage: array of edge objects
+    template <class E>
+    class AosEdgeStore {
     public:
-        EdgeCostFlow(vertex from, vertex to, flow_t capacity, cost_t cost)
-            : EdgeFlow(from, to, capacity), cost_(cost) {
+        typedef const E& const_reference;
+
+        void push_back(const E& e) {
+            edges_.push_back(e);
+        }
+        void reserve(size_t count) {
+            edges_.reserve(count);
+        }
+        size_t size() const {
+            return edges_.size();
+        }
+        void shrink_to_fit() {
+            edges_.shrink_to_fit();
+        }
+        const_reference operator[](size_t id) const {
+            return edges_[id];
+        }
+
+        typename E::vertex_type from(size_t id) const {
+            return edges_[id].from();
+        }
+        typename E::vertex_type to(size_t id) const {
+            return edges_[id].to();
+        }
+        flow_t capacity(size_t id) const {
+            return edges_[id].capacity();
+        }
+        flow_t flow(size_t id) const {
+            return edges_[id].flow();
+        }
+        flow_t residualCapacity(size_t id) const {
+            return edges_[id].residualCapacity();
+        }
+        cost_t cost(size_t id) const {
+            return edges_[id].cost();
+        }
+        int getMark(size_t id) const {
+            return edges_[id].mark;
+        }
+        void setEnds(size_t id, typename E::vertex_type from, typename E::vertex_type to) {
+            edges_[id].setEnds(from, to);
+        }
+
+        flow_t pushFlow(size_t id, flow_t flow) {
+            return edges_[id].pushFlow(flow);
+        }
+        void pushCapacity(size_t id, flow_t flow) {
+            edges_[id].pushCapacity(flow);
         }
-        cost_t cost() const {
-            return cost_;
+        void mark(size_t id, int v) {
+            edges_[id].mark = v;
+        }
+
+        /// Replaces the contents by m edges given column by column, cost and mark may be NULL
+        template <class V, class F, class C>
+        void assignColumns(size_t m, const V* from, const V* to, const F* capacity, const F* flow,
+                           const C* cost, const int* mark) {
+            edges_.clear();
+            edges_.reserve(m);
+            EdgeFields fields;
+            for (size_t i = 0; i < m; ++i) {
+                fields.from = from[i];
+                fields.to = to[i];
+                fields.capacity = capacity[i];
+                fields.flow = flow[i];
+                fields.cost = cost ? cost[i] : 0;
+                fields.mark = mark ? mark[i] : 0;
+                edges_.push_back(E(fields));
+            }
         }
 
     private:
-        cost_t cost_;
+        std::vector<E> edges_;
     };
 
-    class EdgeFlowMarked : public EdgeFlow {
+    /// Structure of arrays storage for flow edges: to[], cap[], flow[], cost[], mark[].
+    /// A scan that needs only to() and residualCapacity() reads two arrays.
+    /// operator[] builds an edge object by value.
+    template <class E>
+    class SoaEdgeStore {
+        static_assert(!E::hasValue, "SoaEdgeStore:: user values are not supported");
     public:
-        EdgeFlowMarked(vertex from, vertex to, flow_t capacity)
-            : EdgeFlow(from, to, capacity), mark(0) {
+        typedef E const_reference;
+        typedef typename E::vertex_type vertex_type;
+        typedef typename E::flow_type flow_type;
+        typedef typename EdgeCostType_<E>::type cost_type;
+
+        static const bool hasCost = E::hasCost;
+        static const bool hasMark = E::hasMark;
+
+        void push_back(const E& e) {
+            from_.push_back(e.from());
+            to_.push_back(e.to());
+            capacity_.push_back(e.capacity());
+            flow_.push_back(e.flow());
+            if (hasCost || hasMark) {
+                EdgeFields fields;
+                e.saveFields(fields);
+                if (hasCost) {
+                    cost_.push_back((cost_type)fields.cost);
+                }
+                if (hasMark) {
+                    mark_.push_back(fields.mark);
+                }
+            }
         }
-        EdgeFlowMarked(vertex from, vertex to, flow_t capacity, int mark)
-            : EdgeFlow(from, to, capacity), mark(mark) {
+        size_t size() const {
+            return to_.size();
         }
-        int mark;
+        void reserve(size_t count) {
+            from_.reserve(count);
+            to_.reserve(count);
+            capacity_.reserve(count);
+            flow_.reserve(count);
+            cost_.reserve(hasCost ? count : 0);
+            mark_.reserve(hasMark ? count : 0);
+        }
+        void shrink_to_fit() {
+            from_.shrink_to_fit();
+            to_.shrink_to_fit();
+            capacity_.shrink_to_fit();
+            flow_.shrink_to_fit();
+            cost_.shrink_to_fit();
+            mark_.shrink_to_fit();
+        }
+        const_reference operator[](size_t id) const {
+            EdgeFields fields;
+            fields.from = from_[id];
+            fields.to = to_[id];
+            fields.capacity = capacity_[id];
+            fields.flow = flow_[id];
+            fields.cost = hasCost ? cost_[id] : 0;
+            fields.mark = hasMark ? mark_[id] : 0;
+            return E(fields);
+        }
+
+        vertex_type from(size_t id) const {
+            return from_[id];
+        }
+        vertex_type to(size_t id) const {
+            return to_[id];
+        }
+        flow_t capacity(size_t id) const {
+            return capacity_[id];
+        }
+        flow_t flow(size_t id) const {
+            return flow_[id];
+        }
+        flow_t residualCapacity(size_t id) const {
+            return capacity_[id] - flow_[id];
+        }
+        cost_t cost(size_t id) const {
+            return cost_[id];
+        }
+        int getMark(size_t id) const {
+            return mark_[id];
+        }
+        void setEnds(size_t id, vertex_type from, vertex_type to) {
+            from_[id] = from;
+            to_[id] = to;
+        }
+
+        flow_t pushFlow(size_t id, flow_t flow) {
+            flow_t addition = std::min(flow, (flow_t)capacity_[id] - flow_[id]);
+            flow_[id] += (flow_type)addition;
+            return addition;
+        }
+        void pushCapacity(size_t id, flow_t flow) {
+            capacity_[id] = checkedCast<flow_type>(capacity_[id] + flow, "EdgeFlow:: capacity overflow");
+        }
+        void mark(size_t id, int v) {
+            mark_[id] = v;
+        }
+
+        /// Replaces the contents by m edges given column by column, cost and mark may be NULL
+        void assignColumns(size_t m, const vertex_type* from, const vertex_type* to,
+                           const flow_type* capacity, const flow_type* flow,
+                           const cost_type* cost, const int* mark) {
+            from_.assign(from, from + m);
+            to_.assign(to, to + m);
+            capacity_.assign(capacity, capacity + m);
+            flow_.assign(flow, flow + m);
+            cost_.assign(cost, cost ? cost + m : cost);
+            mark_.assign(mark, mark ? mark + m : mark);
+        }
+
+    private:
+        std::vector<vertex_type> from_;
+        std::vector<vertex_type> to_;
+        std::vector<flow_type> capacity_;
+        std::vector<flow_type> flow_;
+        std::vector<cost_type> cost_;
+        std::vector<int> mark_;
     };
 
-    class EdgeCostFlowMarked : public EdgeCostFlow {
+    template <class E, template <class> class Store>
+    class Graph;
+
+    template <class G>
+    class BinaryGraphIO;
+
+    /// Contiguous span of edge ids, returned by Graph::neighbors()
+    template <class Id>
+    class EdgeIdRange {
     public:
-        EdgeCostFlowMarked(vertex from, vertex to, flow_t capacity, cost_t cost)
-            : EdgeCostFlow(from, to, capacity, cost), mark(0) {
+        typedef const Id* const_iterator;
+        EdgeIdRange(const Id* first, const Id* last) : first_(first), last_(last) {
         }
-        EdgeCostFlowMarked(vertex from, vertex to, flow_t capacity, cost_t cost, int mark)
-            : EdgeCostFlow(from, to, capacity, cost), mark(mark) {
+        const_iterator begin() const {
+            return first_;
         }
-        int mark;
+        const_iterator end() const {
+            return last_;
+        }
+        size_t size() const {
+            return last_ - first_;
+        }
+        Id operator[](size_t i) const {
+            return first_[i];
+        }
+    private:
+        const Id* first_;
+        const Id* last_;
     };
 
-    template<class E>
-    class Graph;
 
-    template <class E>
-    class GraphBaseIterator: public std::iterator <std::forward_iterator_tag, const E> {
+    /// Iterator over the edges of one vertex. pushFlow()/pushCapacity()/mark()/getMark()
+    /// compile only for edge types that have the corresponding properties.
+    template <class E, template <class> class Store = AosEdgeStore>
+    class GraphIterator: public std::iterator <std::forward_iterator_tag, const E> {
     public:
-        typedef size_t size_type;
-        typedef typename std::iterator <std::forward_iterator_tag, const E>::reference reference;
+        typedef typename E::vertex_type vertex_type;
+        typedef typename E::edge_id_type edge_id_type;
+        typedef edge_id_type size_type;
+        typedef typename Store<E>::const_reference reference;
         typedef typename std::iterator <std::forward_iterator_tag, const E>::difference_type difference_type;
-        GraphBaseIterator()
+        GraphIterator()
             : graph_(NULL) {
         }
-        GraphBaseIterator(Graph<E>* const graph, vertex v, size_t shift)
+        GraphIterator(Graph<E, Store>* const graph, vertex_type v, size_type shift)
             : graph_(graph), v_(v), shift_(shift) {
         }
 
         ///Main operators
         reference operator*() {
-            if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-                return graph_->edgeList_[graph_->edges_[v_][shift_]];
-            } else {
-                throw std::runtime_error("Graph:: iterator:: end() called");
-            }
+            return graph_->edgeList_[id_()];
         }
 
-        GraphBaseIterator& operator+=(const difference_type& indx)
+        GraphIterator& operator+=(const difference_type& indx)
         {
-            shift_ = std::min(shift_ + indx, graph_->edgesCount(v_));
+            shift_ = std::min<size_t>(shift_ + indx, graph_->edgesCount(v_));
             return *this;
         }
 
         ///Clone operators
-        GraphBaseIterator& operator++()
+        GraphIterator& operator++()
         {
             return (*this) += 1;
         }
 
-        GraphBaseIterator operator++(int)
+        GraphIterator operator++(int)
         {
-            GraphBaseIterator temp(*this);
+            GraphIterator temp(*this);
             (*this) += 1;
             return temp;
         }
 
-        GraphBaseIterator operator+(const difference_type& idx) const
+        GraphIterator operator+(const difference_type& idx) const
         {
-            GraphBaseIterator buf(*this);
+            GraphIterator buf(*this);
             return buf += idx;
         }
-        bool operator==(const GraphBaseIterator& other) const
+        bool operator==(const GraphIterator& other) const
         {
             return (v_ == other.v_) && (shift_ == other.shift_);
         }
-        bool operator!=(const GraphBaseIterator& other) const
+        bool operator!=(const GraphIterator& other) const
         {
             return (v_ != other.v_) || (shift_ != other.shift_) ;
         }
         bool isNatural() {
-            return (graph_->edges_[v_][shift_] % 2) == 0;
+            return (graph_->edgeId_(v_, shift_) % 2) == 0;
         }
 
-    protected:
-        Graph<E>* graph_;
-        vertex v_;
-        size_t shift_;
-    };
-
-    template <class E>
-    class GraphIterator: public GraphBaseIterator<E> {
-    public:
-        GraphIterator(Graph<E>* const graph, vertex v, size_t shift)
-            : GraphBaseIterator<E>(graph, v, shift) {
+        flow_t pushFlow(flow_t flow) {
+            return graph_->pushFlow(id_(), flow);
         }
-        GraphIterator()
-            : GraphBaseIterator<E>() {
+        void pushCapacity(flow_t flow) {
+            graph_->edgeList_.pushCapacity(id_(), flow);
         }
-    };
-
-    template <>
-    class GraphIterator<EdgeFlow>: public GraphBaseIterator<EdgeFlow> {
-    public:
-        GraphIterator(Graph<EdgeFlow>* const graph, vertex v, size_t shift)
-            : GraphBaseIterator<EdgeFlow>(graph, v, shift) {
+        void mark(int v) {
+            graph_->edgeList_.mark(id_(), v);
         }
-        GraphIterator()
-            : GraphBaseIterator<EdgeFlow>() {
+        int getMark() const {
+            return graph_->edgeList_.getMark(id_());
         }
-        flow_t pushFlow(flow_t flow);
-        void pushCapacity(flow_t flow);
-    protected:
-    };
 
-    template <>
-    class GraphIterator<EdgeCostFlow>: public GraphBaseIterator<EdgeCostFlow> {
-    public:
-        GraphIterator(Graph<EdgeCostFlow>* const graph, vertex v, size_t shift)
-            : GraphBaseIterator<EdgeCostFlow>(graph, v, shift) {
-        }
-        GraphIterator()
-            : GraphBaseIterator<EdgeCostFlow>() {
-        }
-        flow_t pushFlow(flow_t flow);
-        void pushCapacity(flow_t flow);
     protected:
-    };
+        Graph<E, Store>* graph_;
+        vertex_type v_;
+        size_type shift_;
 
-    template <>
-    class GraphIterator<EdgeFlowMarked>: public GraphBaseIterator<EdgeFlowMarked> {
-    public:
-        GraphIterator(Graph<EdgeFlowMarked>* const graph, vertex v, size_t shift)
-            : GraphBaseIterator<EdgeFlowMarked>(graph, v, shift) {
-        }
-        GraphIterator()
-            : GraphBaseIterator<EdgeFlowMarked>() {
+        edge_id_type id_() const {
+            if (graph_->isVertex(v_) && (shift_ < graph_->edgesCount(v_))) {
+                return graph_->edgeId_(v_, shift_);
+            } else {
+                throw std::runtime_error("Graph:: iterator:: end() called");
+            }
         }
-
-        void mark(int v);
-        int getMark() const;
-        flow_t pushFlow(flow_t flow);
-        void pushCapacity(flow_t flow);
-    protected:
     };
 
-    template <>
-    class GraphIterator<EdgeCostFlowMarked>: public GraphBaseIterator<EdgeCostFlowMarked> {
-    public:
-        GraphIterator(Graph<EdgeCostFlowMarked>* const graph, vertex v, size_t shift)
-            : GraphBaseIterator<EdgeCostFlowMarked>(graph, v, shift) {
-        }
-        GraphIterator()
-            : GraphBaseIterator<EdgeCostFlowMarked>() {
-        }
+    template <class E, template <class> class Store = AosEdgeStore>
+    using GraphBaseIterator = GraphIterator<E, Store>;
 
-        void mark(int v);
-        int getMark() const;
-        flow_t pushFlow(flow_t flow);
-        void pushCapacity(flow_t flow);
-    protected:
+    /// Vertex orders for Graph::reorder()
+    enum ReorderStrategy {
+        REORDER_BFS,    // breadth-first order, neighbours end up with close ids
+        REORDER_RCM,    // reverse Cuthill-McKee, small bandwidth of the adjacency matrix
+        REORDER_DEGREE  // by out-degree, largest first
     };
 
-    template <class E>
+    /// Vertex and edge index types come from the edge type (E::vertex_type, E::edge_id_type);
+    /// counts that do not fit into them are rejected when vertices and edges are pushed.
+    template <class E, template <class> class Store = AosEdgeStore>
     class Graph {
     public:
-        Graph() {
+        typedef E edge_type;
+        typedef typename E::vertex_type vertex_type;
+        typedef typename E::edge_id_type edge_id_type;
+        typedef GraphIterator<E, Store> base_iterator;
+
+        Graph() : frozen_(false) {
         }
 
-        Graph(size_t vertexCount) {
+        Graph(size_t vertexCount) : frozen_(false) {
             this->pushVertex(vertexCount);
         }
 
-        friend class GraphBaseIterator<E>;
-        friend class GraphIterator<E>;
-        virtual vertex pushVertex() {
-            edges_.push_back(std::vector<vertex>());
-            return edges_.size() - 1;
+        friend class GraphIterator<E, Store>;
+        template <class G>
+        friend class BinaryGraphIO;
+
+        vertex_type pushVertex() {
+            return pushVertex(1);
         }
 
-        virtual vertex pushVertex(size_t count) {
+        vertex_type pushVertex(size_t count) {
+            checkNotFrozen_();
+            checkedCast<vertex_type>(edges_.size() + count, "Graph:: too many vertices for vertex type");
             edges_.resize(edges_.size() + count);
             return edges_.size() - 1;
         }
 
-        virtual void pushEdge(E e) {
+        void pushEdge(E e) {
+            checkNotFrozen_();
             if (isVertex(e.from()) && isVertex(e.to())) {
-                edges_[e.from()].push_back(edgeList_.size());
+                edge_id_type id = checkedCast<edge_id_type>(edgeList_.size(), "Graph:: too many edges for edge id type");
+                edges_[e.from()].push_back(id);
                 edgeList_.push_back(e);
             } else {
                 throw std::runtime_error("Graph:: vertex out of bounds");
             }
         }
 
-        size_t vertexCount() const {
-            return edges_.size();
+        /// Packs adjacency lists into CSR arrays (offsets + edge ids).
+        /// Edge ids are kept, so back edges are still at id ^ 1.
+        /// No vertices or edges can be pushed after that.
+        void freeze() {
+            if (frozen_) {
+                return;
+            }
+            offsets_.assign(edges_.size() + 1, 0);
+            for (size_t v = 0; v < edges_.size(); ++v) {
+                offsets_[v + 1] = offsets_[v] + edges_[v].size();
+            }
+            adjacency_.resize(offsets_.back());
+            for (size_t v = 0; v < edges_.size(); ++v) {
+                std::copy(edges_[v].begin(), edges_[v].end(), adjacency_.begin() + offsets_[v]);
+            }
+            std::vector<std::vector<edge_id_type>>().swap(edges_);
+            edgeList_.shrink_to_fit();
+            frozen_ = true;
         }
 
-        size_t edgesCount() const {
-            return edgeList_.size();
+        bool isFrozen() const {
+            return frozen_;
+        }
+
+        /// Renumbers vertices for better memory locality of traversals.
+        /// Returns perm with perm[old] = new, so a result computed on the reordered graph
+        /// maps back as resultOld[v] = resultNew[perm[v]].
+        /// Edge ids do not change (back edges stay at id ^ 1), BFS starts from root.
+        std::vector<vertex_type> reorder(ReorderStrategy strategy, vertex_type root = 0) {
+            size_t n = vertexCount();
+            std::vector<vertex_type> order = vertexOrder_(strategy, root);
+            std::vector<vertex_type> perm(n);
+            for (size_t i = 0; i < n; ++i) {
+                perm[order[i]] = i;
+            }
+
+            for (size_t id = 0; id < edgeList_.size(); ++id) {
+                edgeList_.setEnds(id, perm[edgeList_.from(id)], perm[edgeList_.to(id)]);
+            }
+            if (frozen_) {
+                std::vector<edge_id_type> offsets(n + 1, 0);
+                std::vector<edge_id_type> adjacency(adjacency_.size());
+                for (size_t v = 0; v < n; ++v) {
+                    EdgeIdRange<edge_id_type> ids = neighbors(order[v]);
+                    std::copy(ids.begin(), ids.end(), adjacency.begin() + offsets[v]);
+                    offsets[v + 1] = offsets[v] + ids.size();
+                }
+                offsets_.swap(offsets);
+                adjacency_.swap(adjacency);
+            } else {
+                std::vector<std::vector<edge_id_type>> edges(n);
+                for (size_t v = 0; v < n; ++v) {
+                    edges[v].swap(edges_[order[v]]);
+                }
+                edges_.swap(edges);
+            }
+            return perm;
         }
 
-        size_t edgesCount(vertex v) const {
-            return edges_[v].size();
+        /// Builds a frozen graph from a flat edge array in one go: edge i gets id i,
+        /// adjacency is filled by a counting sort on from(), optionally on several threads.
+        /// The result is the same as pushEdge() for every edge followed by freeze().
+        static Graph fromEdgeList(size_t vertexCount, const std::vector<E>& edges, size_t threads = 1) {
+            Graph g(vertexCount);
+            g.reserveEdges_(edges.size());
+            for (size_t i = 0; i < edges.size(); ++i) {
+                g.appendEdge_(edges[i]);
+            }
+            g.buildAdjacency_(threads);
+            return g;
         }
 
-        bool isVertex(vertex v) const {
-            return v < vertexCount();
+        size_t vertexCount() const {
+            return frozen_ ? offsets_.size() - 1 : edges_.size();
         }
 
-        typedef GraphIterator<E> base_iterator;
+        size_t edgesCount() const {
+            return edgeList_.size();
+        }
 
-        base_iterator begin(vertex v) {
-            return base_iterator(this, v, 0);
+        size_t edgesCount(vertex_type v) const {
+            return frozen_ ? offsets_[v + 1] - offsets_[v] : edges_[v].size();
         }
 
-        base_iterator end(vertex v) {
-            return base_iterator(this, v, edges_[v].size());
+        bool isVertex(vertex_type v) const {
+            return !isNegative(v) && ((size_t)v < vertexCount());
         }
 
-        base_iterator getEdge(vertex v, size_t shift) {
-            if (isVertex(v) && (shift < edges_[v].size())) {
-                return base_iterator(this, v, shift);
-            } else {
+        /// Unchecked access for hot loops, define SGTL_DEBUG to get the checks back
+        EdgeIdRange<edge_id_type> neighbors(vertex_type v) const {
+#ifdef SGTL_DEBUG
+            if (!isVertex(v)) {
                 throw std::runtime_error("Graph:: vertex out of bounds");
             }
+#endif
+            const edge_id_type* first = frozen_ ? adjacency_.data() + offsets_[v] : edges_[v].data();
+            return EdgeIdRange<edge_id_type>(first, first + edgesCount(v));
         }
 
-    private:
-        std::vector<std::vector<vertex>> edges_;
-        std::vector<E> edgeList_;
-    };
+        typename Store<E>::const_reference edge(size_t id) const {
+            checkEdge_(id);
+            return edgeList_[id];
+        }
 
-    flow_t GraphIterator<EdgeFlow>::pushFlow(flow_t flow) {
-        // return (*(*this)).pushFlow(flow); is incorrect because reference is const EdgeFlow
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            flow_t pushed = graph_->edgeList_[graph_->edges_[v_][shift_]].pushFlow(flow);
-            size_t backEdgeIndex = (graph_->edges_[v_][shift_]) ^ 1;
-            graph_->edgeList_[backEdgeIndex].pushFlow((flow_t)0 - pushed);
-            return pushed;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        vertex_type from(size_t id) const {
+            checkEdge_(id);
+            return edgeList_.from(id);
         }
-    }
 
-    flow_t GraphIterator<EdgeCostFlow>::pushFlow(flow_t flow) {
-        // return (*(*this)).pushCostFlow(flow); is incorrect because reference is const EdgeFlow
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            flow_t pushed = graph_->edgeList_[graph_->edges_[v_][shift_]].pushFlow(flow);
-            size_t backEdgeIndex = (graph_->edges_[v_][shift_]) ^ 1;
-            graph_->edgeList_[backEdgeIndex].pushFlow((flow_t)0 - pushed);
-            return pushed;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        vertex_type to(size_t id) const {
+            checkEdge_(id);
+            return edgeList_.to(id);
         }
-    }
 
-    void GraphIterator<EdgeFlow>::pushCapacity(flow_t flow) {
-        // return (*(*this)).pushFlow(flow); is incorrect because reference is const EdgeFlow
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            graph_->edgeList_[graph_->edges_[v_][shift_]].pushCapacity(flow);
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        flow_t capacity(size_t id) const {
+            checkEdge_(id);
+            return edgeList_.capacity(id);
         }
-    }
 
-    flow_t GraphIterator<EdgeFlowMarked>::pushFlow(flow_t flow) {
-        // return (*(*this)).pushCostFlow(flow); is incorrect because reference is const EdgeFlow
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            flow_t pushed = graph_->edgeList_[graph_->edges_[v_][shift_]].pushFlow(flow);
-            size_t backEdgeIndex = (graph_->edges_[v_][shift_]) ^ 1;
-            graph_->edgeList_[backEdgeIndex].pushFlow((flow_t)0 - pushed);
-            return pushed;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        flow_t flow(size_t id) const {
+            checkEdge_(id);
+            return edgeList_.flow(id);
         }
-    }
 
-    void GraphIterator<EdgeFlowMarked>::mark(int v) {
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            graph_->edgeList_[graph_->edges_[v_][shift_]].mark = v;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        flow_t residualCapacity(size_t id) const {
+            checkEdge_(id);
+            return edgeList_.residualCapacity(id);
         }
-    }
 
-    int GraphIterator<EdgeFlowMarked>::getMark() const {
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            return graph_->edgeList_[graph_->edges_[v_][shift_]].mark;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        cost_t cost(size_t id) const {
+            checkEdge_(id);
+            return edgeList_.cost(id);
         }
-    }
 
-    flow_t GraphIterator<EdgeCostFlowMarked>::pushFlow(flow_t flow) {
-        // return (*(*this)).pushCostFlow(flow); is incorrect because reference is const EdgeFlow
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            flow_t pushed = graph_->edgeList_[graph_->edges_[v_][shift_]].pushFlow(flow);
-            size_t backEdgeIndex = (graph_->edges_[v_][shift_]) ^ 1;
-            graph_->edgeList_[backEdgeIndex].pushFlow((flow_t)0 - pushed);
+        /// Pushes flow along edge id and takes it back from its pair id ^ 1
+        flow_t pushFlow(size_t id, flow_t flow) {
+            checkEdge_(id);
+            flow_t pushed = edgeList_.pushFlow(id, flow);
+            edgeList_.pushFlow(id ^ 1, (flow_t)0 - pushed);
             return pushed;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
         }
-    }
 
-    void GraphIterator<EdgeCostFlowMarked>::mark(int v) {
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            graph_->edgeList_[graph_->edges_[v_][shift_]].mark = v;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        /// Changes the capacity of edge id by delta, the flow is not touched
+        void pushCapacity(size_t id, flow_t delta) {
+            checkEdge_(id);
+            edgeList_.pushCapacity(id, delta);
         }
-    }
 
-    int GraphIterator<EdgeCostFlowMarked>::getMark() const {
-        if (graph_->isVertex(v_) && (shift_ < graph_->edges_[v_].size())) {
-            return graph_->edgeList_[graph_->edges_[v_][shift_]].mark;
-        } else {
-            throw std::runtime_error("Graph:: iterator:: end() called");
+        base_iterator begin(vertex_type v) {
+            return base_iterator(this, v, 0);
         }
-    }
-    template <class E>
-    class Network : public Graph<E> {
+
+        base_iterator end(vertex_type v) {
+            return base_iterator(this, v, edgesCount(v));
+        }
+
+        base_iterator getEdge(vertex_type v, size_t shift) {
+            if (isVertex(v) && (shift < edgesCount(v))) {
+                return base_iterator(this, v, shift);
+            } else {
+                throw std::runtime_error("Graph:: vertex out of bounds");
+            }
+        }
+
+    protected:
+        void reserveEdges_(size_t count) {
+            edgeList_.reserve(count);
+        }
+
+        /// Stores an edge without touching adjacency, buildAdjacency_() indexes it later
+        void appendEdge_(const E& e) {
+            if (!isVertex(e.from()) || !isVertex(e.to())) {
+                throw std::runtime_error("Graph:: vertex out of bounds");
+            }
+            edgeList_.push_back(e);
+        }
+
+        /// Counting sort of all stored edge ids by from() into CSR arrays
+        void buildAdjacency_(size_t threads) {
+            checkNotFrozen_();
+            size_t n = vertexCount();
+            size_t m = edgeList_.size();
+            checkedCast<edge_id_type>(m, "Graph:: too many edges for edge id type");
+            threads = std::max<size_t>(1, std::min(threads, m / 1024));
+
+            std::vector<std::vector<edge_id_type>> position(threads, std::vector<edge_id_type>(n, 0));
+            parallelRun(threads, [&](size_t t) {
+                for (size_t id = m * t / threads; id < m * (t + 1) / threads; ++id) {
+                    ++position[t][edgeList_.from(id)];
+                }
+            });
+
+            offsets_.assign(n + 1, 0);
+            for (size_t v = 0; v < n; ++v) {
+                edge_id_type next = offsets_[v];
+                for (size_t t = 0; t < threads; ++t) {
+                    edge_id_type count = position[t][v];
+                    position[t][v] = next;
+                    next += count;
+                }
+                offsets_[v + 1] = next;
+            }
+
+            adjacency_.resize(m);
+            parallelRun(threads, [&](size_t t) {
+                for (size_t id = m * t / threads; id < m * (t + 1) / threads; ++id) {
+                    adjacency_[position[t][edgeList_.from(id)]++] = id;
+                }
+            });
+            std::vector<std::vector<edge_id_type>>().swap(edges_);
+            frozen_ = true;
+        }
+
+    private:
+        std::vector<std::vector<edge_id_type>> edges_;
+        Store<E> edgeList_;
+
+        bool frozen_;
+        std::vector<edge_id_type> offsets_;
+        std::vector<edge_id_type> adjacency_;
+
+        edge_id_type edgeId_(vertex_type v, size_t shift) const {
+            return frozen_ ? adjacency_[offsets_[v] + shift] : edges_[v][shift];
+        }
+
+        void checkEdge_(size_t id) const {
+#ifdef SGTL_DEBUG
+            if (id >= edgeList_.size()) {
+                throw std::runtime_error("Graph:: edge out of bounds");
+            }
+#else
+            (void)id;
+#endif
+        }
+
+        void checkNotFrozen_() const {
+            if (frozen_) {
+                throw std::runtime_error("Graph:: graph is frozen");
+            }
+        }
+
+        /// Old vertex ids in their new order
+        std::vector<vertex_type> vertexOrder_(ReorderStrategy strategy, vertex_type root) const {
+            size_t n = vertexCount();
+            std::vector<vertex_type> order;
+            order.reserve(n);
+            if (strategy == REORDER_DEGREE) {
+                for (size_t v = 0; v < n; ++v) {
+                    order.push_back(v);
+                }
+                std::stable_sort(order.begin(), order.end(), [this](vertex_type a, vertex_type b) {
+                    return edgesCount(a) > edgesCount(b);
+                });
+                return order;
+            }
+            if ((strategy != REORDER_BFS) && (strategy != REORDER_RCM)) {
+                throw std::runtime_error("Graph:: unknown reorder strategy");
+            }
+            if ((n > 0) && !isVertex(root)) {
+                throw std::runtime_error("Graph:: vertex out of bounds");
+            }
+
+            /// RCM starts every component from a vertex of minimal degree
+            /// and visits neighbours by increasing degree
+            std::vector<vertex_type> byDegree;
+            if (strategy == REORDER_RCM) {
+                for (size_t v = 0; v < n; ++v) {
+                    byDegree.push_back(v);
+                }
+                std::stable_sort(byDegree.begin(), byDegree.end(), [this](vertex_type a, vertex_type b) {
+                    return edgesCount(a) < edgesCount(b);
+                });
+            }
+
+            std::vector<char> used(n, 0);
+            size_t next = 0;
+            for (size_t head = 0; order.size() < n; ++head) {
+                if (head == order.size()) {
+                    vertex_type start;
+                    if (strategy == REORDER_RCM) {
+                        while (used[byDegree[next]]) {
+                            ++next;
+                        }
+                        start = byDegree[next];
+                    } else if (head == 0) {
+                        start = root;
+                    } else {
+                        while (used[next]) {
+                            ++next;
+                        }
+                        start = next;
+                    }
+                    used[start] = 1;
+                    order.push_back(start);
+                }
+                size_t first = order.size();
+                for (edge_id_type id : neighbors(order[head])) {
+                    vertex_type to = edgeList_.to(id);
+                    if (!used[to]) {
+                        used[to] = 1;
+                        order.push_back(to);
+                    }
+                }
+                if (strategy == REORDER_RCM) {
+                    std::stable_sort(order.begin() + first, order.end(), [this](vertex_type a, vertex_type b) {
+                        return edgesCount(a) < edgesCount(b);
+                    });
+                }
+            }
+            if (strategy == REORDER_RCM) {
+                std::reverse(order.begin(), order.end());
+            }
+            return order;
+        }
+    };
+
+    template <class E, template <class> class Store = AosEdgeStore>
+    class Network : public Graph<E, Store> {
     public:
+        typedef typename Graph<E, Store>::vertex_type vertex_type;
+
         // Hell, yeah!
-        Network(size_t vertexCount, vertex source, vertex target) :source_(source), target_(target) {
+        Network(size_t vertexCount, vertex_type source, vertex_type target) :source_(source), target_(target) {
             this->pushVertex(vertexCount);
             if (!this->isVertex(source_) || !this->isVertex(target_)) {
                 throw std::runtime_error("Network:: source or target out of bounds");
             }
         }
 
-        vertex getSource() const {
+        vertex_type getSource() const {
             return source_;
         }
 
-        vertex getTarget() const {
+        vertex_type getTarget() const {
             return target_;
         }
 
-        virtual void pushEdge(E edge) {
+        /// Hides Graph::pushEdge(): every edge comes with its back edge
+        void pushEdge(E edge) {
             if (this->isVertex(edge.from()) && this->isVertex(edge.to())) {
-                E backEdge(edge.to(), edge.from(), 0);
-                Graph<E>::pushEdge(edge);
-                Graph<E>::pushEdge(backEdge);
+                Graph<E, Store>::pushEdge(edge);
+                Graph<E, Store>::pushEdge(backEdge(edge));
             } else {
                 throw std::runtime_error("Graph:: vertex out of bounds");
             }
         }
 
-    private:
-        vertex source_;
-        vertex target_;
-    };
-
-    template <>
-    void Network<EdgeCostFlow>::pushEdge(EdgeCostFlow edge) {
-        if (this->isVertex(edge.from()) && this->isVertex(edge.to())) {
-            EdgeCostFlow backEdge(edge.to(), edge.from(), 0, 0 - edge.cost());
-            Graph<EdgeCostFlow>::pushEdge(edge);
-            Graph<EdgeCostFlow>::pushEdge(backEdge);
-        } else {
-            throw std::runtime_error("Graph:: vertex out of bounds");
+        /// Bulk version of pushEdge() for every edge: edge i and its back edge get ids 2i and 2i + 1,
+        /// the network comes out frozen
+        static Network build(size_t vertexCount, vertex_type source, vertex_type target,
+                             const std::vector<E>& edges, size_t threads = 1) {
+            Network g(vertexCount, source, target);
+            g.reserveEdges_(2 * edges.size());
+            for (size_t i = 0; i < edges.size(); ++i) {
+                g.appendEdge_(edges[i]);
+                g.appendEdge_(backEdge(edges[i]));
+            }
+            g.buildAdjacency_(threads);
+            return g;
         }
-    }
 
-    template <>
-    void Network<EdgeCostFlowMarked>::pushEdge(EdgeCostFlowMarked edge) {
-        if (this->isVertex(edge.from()) && this->isVertex(edge.to())) {
-            EdgeCostFlowMarked backEdge(edge.to(), edge.from(), 0, 0 - edge.cost());
-            Graph<EdgeCostFlowMarked>::pushEdge(edge);
-            Graph<EdgeCostFlowMarked>::pushEdge(backEdge);
-        } else {
-            throw std::runtime_error("Graph:: vertex out of bounds");
+        /// Graph::reorder() that also renumbers source and target, BFS starts from the source
+        std::vector<vertex_type> reorder(ReorderStrategy strategy) {
+            std::vector<vertex_type> perm = Graph<E, Store>::reorder(strategy, source_);
+            source_ = perm[source_];
+            target_ = perm[target_];
+            return perm;
         }
-    }
+
+    private:
+        vertex_type source_;
+        vertex_type target_;
+    };
 
 }
 
 
 
 ////////////////////////////////////////////////////////////
-// bfs.h
+// binary.h
 ////////////////////////////////////////////////////////////
 
-#include <queue>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace sgtl {
-    class DFS {
+    /// On-disk layout, version 1: this header, then 8-byte aligned arrays
+    /// offsets[V + 1], adjacency[E] (edge ids), from[E], to[E], capacity[E], flow[E],
+    /// cost[E] (only with BINARY_HAS_COST), mark[E] (int, only with BINARY_HAS_MARK).
+    /// Everything is stored in the native types of the edge, so the arrays can be used straight from mmap.
+    struct BinaryGraphHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t flags;
+        uint8_t vertexSize;
+        uint8_t edgeIdSize;
+        uint8_t flowSize;
+        uint8_t costSize;
+        uint64_t vertexCount;
+        uint64_t edgesCount;
+        uint64_t source;
+        uint64_t target;
+    };
+
+    const char BINARY_MAGIC[8] = {'S', 'G', 'T', 'L', 'G', 'R', 'P', 'H'};
+    const uint32_t BINARY_VERSION = 1;
+    const uint32_t BINARY_BYTE_ORDER = 0x01020304;
+    const uint32_t BINARY_NETWORK = 1;
+    const uint32_t BINARY_HAS_COST = 2;
+    const uint32_t BINARY_HAS_MARK = 4;
+
+    /// Read-only private mapping of a whole file
+    class MappedFile {
     public:
-        static void dfs(vertex v, Graph<Edge> &gr, std::vector<int> &order, int color) {
-            order[v] = color;
-            for (auto e = gr.begin(v); e != gr.end(v); ++e) {
-                if (!order[(*e).to()]) {
-                    dfs((*e).to(), gr, order, color);
+        explicit MappedFile(const std::string& path) : data_(NULL), size_(0) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("MappedFile:: cannot open " + path);
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw std::runtime_error("MappedFile:: cannot stat " + path);
+            }
+            size_ = st.st_size;
+            if (size_ > 0) {
+                void* data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    close(fd);
+                    throw std::runtime_error("MappedFile:: cannot map " + path);
                 }
+                data_ = static_cast<const char*>(data);
             }
+            close(fd);
         }
-        static void dfsSeries(Graph<Edge> &gr, std::vector<int> &order) {
-            order.assign(gr.vertexCount(), 0);
-            for (vertex i = 0; i < gr.vertexCount(); ++i) {
-                if (!order[i]) {
-                    dfs(i, gr, order, i + 1);
-                }
+
+        ~MappedFile() {
+            if (data_) {
+                munmap(const_cast<char*>(data_), size_);
             }
         }
-    private:
-        DFS() { // only static class
+
+        size_t size() const {
+            return size_;
         }
-    };
 
-    class BFS {
-    public:
-        template <class E>
-        static void bfsUntil(Graph<E>& g, vertex v, vertex to, std::vector<vertex>& level) {
-            if (!g.isVertex(v)) {
-                throw std::runtime_error("bsf :: vertex out of bounds");
+        /// count values of T starting at offset, throws if the file is too short
+        template <class T>
+        const T* array(size_t offset, size_t count) const {
+            if ((offset > size_) || (count > (size_ - offset) / sizeof(T))) {
+                throw std::runtime_error("MappedFile:: file is truncated");
             }
-            level.assign(g.vertexCount(), 0);
-            level[v] = 1;
+            return reinterpret_cast<const T*>(data_ + offset);
+        }
 
-            std::queue <vertex> qq;
-            qq.push(v);
+    private:
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
 
-            while (!qq.empty() && (level[to] == 0)) {
-                v = qq.front();
-                qq.pop();
+        const char* data_;
+        size_t size_;
+    };
 
-                for (auto edge = g.begin(v); edge != g.end(v); ++edge) {
-                    if ((level[(*edge).to()] == 0) && (*edge).unsaturated()) {
-                        level[(*edge).to()] = level[v] + 1;
-                        qq.push((*edge).to());
-                    }
-                }
+    class BinaryWriter {
+    public:
+        explicit BinaryWriter(const std::string& path) : written_(0) {
+            file_ = fopen(path.c_str(), "wb");
+            if (!file_) {
+                throw std::runtime_error("BinaryWriter:: cannot open " + path);
             }
         }
-    private:
-        BFS() { // only static class
+
+        ~BinaryWriter() {
+            if (file_) {
+                fclose(file_);
+            }
         }
-    };
-}
 
-////////////////////////////////////////////////////////////
-// flow.h
-////////////////////////////////////////////////////////////
+        void write(const void* data, size_t bytes) {
+            if (bytes && (fwrite(data, 1, bytes, file_) != bytes)) {
+                throw std::runtime_error("BinaryWriter:: write failed");
+            }
+            written_ += bytes;
+        }
 
-namespace sgtl {
-    template<class Network>
-    class Dinitz {
-    public:
-        static Dinitz& instance() {
-            static Dinitz forewerAlone;
-            return forewerAlone;
+        void align() {
+            static const char zeros[8] = {0};
+            write(zeros, (8 - written_ % 8) % 8);
         }
-        static flow_t getMaxFlow(Network& g) {
-            return instance().getMaxFlow_(g);
+
+        /// Writes count values get(0), ..., get(count - 1) as T and pads to 8 bytes
+        template <class T, class Get>
+        void column(size_t count, Get get) {
+            const size_t CHUNK = 4096;
+            T buffer[CHUNK];
+            for (size_t i = 0; i < count; i += CHUNK) {
+                size_t len = std::min(CHUNK, count - i);
+                for (size_t j = 0; j < len; ++j) {
+                    buffer[j] = (T)get(i + j);
+                }
+                write(buffer, len * sizeof(T));
+            }
+            align();
+        }
+
+        void close() {
+            if (fclose(file_) != 0) {
+                file_ = NULL;
+                throw std::runtime_error("BinaryWriter:: close failed");
+            }
+            file_ = NULL;
         }
 
     private:
-        Dinitz(){}  // singleton? yes, thanks
-        Dinitz(const Dinitz& root);
-        Dinitz& operator=(const Dinitz&);
+        BinaryWriter(const BinaryWriter&);
+        BinaryWriter& operator=(const BinaryWriter&);
 
-        std::vector<vertex> level_;
-        std::vector<typename Network::base_iterator> ptr_;
+        FILE* file_;
+        size_t written_;
+    };
 
-        flow_t getMaxFlow_(Network& g) {
-            flow_t flow = 0;
-            flow_t push;
+    template <class G>
+    class BinaryGraphIO {
+    public:
+        typedef typename G::edge_type E;
+        typedef typename G::vertex_type V;
+        typedef typename G::edge_id_type Id;
+        typedef typename E::flow_type F;
+        typedef typename EdgeCostType_<E>::type C;
 
-            ptr_.resize(g.vertexCount());
+        static const bool hasCost = E::hasCost;
+        static const bool hasMark = E::hasMark;
 
-            while (true) {
-                BFS::bfsUntil(g, g.getSource(), g.getTarget(), level_);
-                if (level_[g.getTarget()] == 0) {
-                    break;
+        static void save(const G& g, const std::string& path, bool isNetwork, uint64_t source, uint64_t target) {
+            size_t n = g.vertexCount();
+            size_t m = g.edgesCount();
+            BinaryGraphHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+            header.version = BINARY_VERSION;
+            header.byteOrder = BINARY_BYTE_ORDER;
+            header.flags = (isNetwork ? BINARY_NETWORK : 0) | (hasCost ? BINARY_HAS_COST : 0)
+                    | (hasMark ? BINARY_HAS_MARK : 0);
+            fillSizes_(header);
+            header.vertexCount = n;
+            header.edgesCount = m;
+            header.source = source;
+            header.target = target;
+
+            BinaryWriter out(path);
+            out.write(&header, sizeof(header));
+            out.align();
+
+            size_t offset = 0;
+            out.column<Id>(n + 1, [&](size_t v) {
+                size_t current = offset;
+                if (v < n) {
+                    offset += g.edgesCount(v);
                 }
-                for (vertex v = 0; v < g.vertexCount(); ++v) {
-                    ptr_[v] = g.begin(v);
+                return current;
+            });
+            for (size_t v = 0; v < n; ++v) {
+                auto ids = g.neighbors(v);
+                out.write(ids.begin(), ids.size() * sizeof(Id));
+            }
+            out.align();
+
+            const auto& store = g.edgeList_;
+            out.column<V>(m, [&](size_t id) { return store.from(id); });
+            out.column<V>(m, [&](size_t id) { return store.to(id); });
+            out.column<F>(m, [&](size_t id) { return store.capacity(id); });
+            out.column<F>(m, [&](size_t id) { return store.flow(id); });
+            writeCost_(out, store, m, std::integral_constant<bool, hasCost>());
+            writeMark_(out, store, m, std::integral_constant<bool, hasMark>());
+            out.close();
+        }
+
+        static BinaryGraphHeader readHeader(const MappedFile& file) {
+            BinaryGraphHeader header = *file.array<BinaryGraphHeader>(0, 1);
+            BinaryGraphHeader expected;
+            fillSizes_(expected);
+            if (memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0) {
+                throw std::runtime_error("BinaryGraphIO:: not a graph file");
+            }
+            if ((header.version != BINARY_VERSION) || (header.byteOrder != BINARY_BYTE_ORDER)) {
+                throw std::runtime_error("BinaryGraphIO:: unsupported version or byte order");
+            }
+            if ((header.vertexSize != expected.vertexSize) || (header.edgeIdSize != expected.edgeIdSize)
+                    || (header.flowSize != expected.flowSize) || (header.costSize != expected.costSize)
+                    || (((header.flags & BINARY_HAS_COST) != 0) != hasCost)
+                    || (((header.flags & BINARY_HAS_MARK) != 0) != hasMark)) {
+                throw std::runtime_error("BinaryGraphIO:: edge type does not match the file");
+            }
+            checkedCast<V>(header.vertexCount, "BinaryGraphIO:: too many vertices for vertex type");
+            checkedCast<Id>(header.edgesCount, "BinaryGraphIO:: too many edges for edge id type");
+            return header;
+        }
+
+        /// Fills g (already holding header.vertexCount vertices and no edges) from the mapping
+        static void load(G& g, const MappedFile& file, const BinaryGraphHeader& header) {
+            size_t n = header.vertexCount;
+            size_t m = header.edgesCount;
+            size_t position = aligned_(sizeof(BinaryGraphHeader));
+            const Id* offsets = next_<Id>(file, position, n + 1);
+            const Id* adjacency = next_<Id>(file, position, m);
+            const V* from = next_<V>(file, position, m);
+            const V* to = next_<V>(file, position, m);
+            const F* capacity = next_<F>(file, position, m);
+            const F* flow = next_<F>(file, position, m);
+            const C* cost = hasCost ? next_<C>(file, position, m) : NULL;
+            const int* mark = hasMark ? next_<int>(file, position, m) : NULL;
+
+            if (offsets[0] != 0 || (size_t)offsets[n] != m) {
+                throw std::runtime_error("BinaryGraphIO:: corrupted offsets");
+            }
+            for (size_t v = 0; v < n; ++v) {
+                if (offsets[v] > offsets[v + 1]) {
+                    throw std::runtime_error("BinaryGraphIO:: corrupted offsets");
                 }
-                while ((push = dfsPushFlow_(g, MAX_FLOW))) {
-                    flow += push;
+            }
+            for (size_t i = 0; i < m; ++i) {
+                if (((size_t)adjacency[i] >= m) || ((size_t)from[i] >= n) || ((size_t)to[i] >= n)) {
+                    throw std::runtime_error("BinaryGraphIO:: corrupted edges");
                 }
             }
-            return flow;
-        }
 
+            g.edgeList_.assignColumns(m, from, to, capacity, flow, cost, mark);
+            g.offsets_.assign(offsets, offsets + n + 1);
+            g.adjacency_.assign(adjacency, adjacency + m);
+            std::vector<std::vector<Id>>().swap(g.edges_);
+            g.frozen_ = true;
+        }
 
+    private:
+        static void fillSizes_(BinaryGraphHeader& header) {
+            header.vertexSize = sizeof(V);
+            header.edgeIdSize = sizeof(Id);
+            header.flowSize = sizeof(F);
+            header.costSize = hasCost ? sizeof(C) : 0;
+        }
 
-        flow_t dfsPushFlow_(Network& g, flow_t flow) {
-            return dfsPushFlow_(g, flow, g.getSource());
+        static size_t aligned_(size_t position) {
+            return (position + 7) / 8 * 8;
         }
 
-        flow_t dfsPushFlow_(Network& g, flow_t flow, vertex v) {
-            if (!flow) {
-                return 0;
-            }
-            if (v == g.getTarget()) {
-                return flow;
-            }
-            for (; ptr_[v] != g.end(v); ++ptr_[v]) {
-                if (level_[v] + 1 == level_[(*ptr_[v]).to()])
-                    if ((*ptr_[v]).unsaturated()) {
-                        flow_t pushed = 0;
-                        flow_t tryPushFlow = std::min(flow, (*ptr_[v]).residualCapacity());
-                        if ((pushed = dfsPushFlow_(g, tryPushFlow, (*ptr_[v]).to()))) {
-                            ptr_[v].pushFlow(pushed);
-                            return pushed;
-                        }
-                    }
-            }
-            return 0;
+        template <class T>
+        static const T* next_(const MappedFile& file, size_t& position, size_t count) {
+            const T* data = file.array<T>(position, count);
+            position = aligned_(position + count * sizeof(T));
+            return data;
         }
 
+        template <class Store>
+        static void writeCost_(BinaryWriter& out, const Store& store, size_t m, std::true_type) {
+            out.column<C>(m, [&](size_t id) { return store.cost(id); });
+        }
+        template <class Store>
+        static void writeCost_(BinaryWriter&, const Store&, size_t, std::false_type) {
+        }
+        template <class Store>
+        static void writeMark_(BinaryWriter& out, const Store& store, size_t m, std::true_type) {
+            out.column<int>(m, [&](size_t id) { return store.getMark(id); });
+        }
+        template <class Store>
+        static void writeMark_(BinaryWriter&, const Store&, size_t, std::false_type) {
+        }
     };
-}
 
-////////////////////////////////////////////////////////////
-// dijkstra.h
-////////////////////////////////////////////////////////////
+    /// Snapshots a graph with its current flows, the file can be loaded back by loadBinary()
+    template <class E, template <class> class Store>
+    void saveBinary(const Graph<E, Store>& g, const std::string& path) {
+        BinaryGraphIO<Graph<E, Store>>::save(g, path, false, 0, 0);
+    }
 
-namespace sgtl{
-    template <class E, class Weight>
-    void dijkstra(Graph<E>& g, vertex v, std::vector<Weight> &shortest, std::function<Weight(const E& e)> cost, Weight INF) {
-        shortest.assign(g.vertexCount(), INF);
-        shortest[v] = 0;
-        std::priority_queue< std::pair<Weight, vertex> > qq;
-        qq.push(std::make_pair(Weight(), v));
-        while (!qq.empty()) {
-            std::pair <Weight, vertex> q = qq.top(); qq.pop();
-            Weight v = q.second;
-            Weight vCost = -q.first;
-            if (shortest[q.second] == vCost) {
-                for (auto e = g.begin(v); e != g.end(v); ++e) {
-                    Weight newCost = vCost + cost(*e);
-                    if (shortest[(*e).to()] > newCost) {
-                        shortest[(*e).to()] = newCost;
-                        qq.push(std::make_pair(-newCost, (*e).to()));
-                    }
-                }
-            }
+    template <class E, template <class> class Store>
+    void saveBinary(const Network<E, Store>& g, const std::string& path) {
+        BinaryGraphIO<Network<E, Store>>::save(g, path, true, g.getSource(), g.getTarget());
+    }
+
+    template <class E, template <class> class Store>
+    Graph<E, Store> makeLoaded_(Graph<E, Store>*, const BinaryGraphHeader& header) {
+        return Graph<E, Store>(header.vertexCount);
+    }
+
+    template <class E, template <class> class Store>
+    Network<E, Store> makeLoaded_(Network<E, Store>*, const BinaryGraphHeader& header) {
+        if (!(header.flags & BINARY_NETWORK)) {
+            throw std::runtime_error("BinaryGraphIO:: file has no source and target");
         }
+        return Network<E, Store>(header.vertexCount, header.source, header.target);
     }
-}
 
+    /// Maps the file read-only and copies its arrays into a frozen G (Graph or Network) without parsing
+    template <class G>
+    G loadBinary(const std::string& path) {
+        MappedFile file(path);
+        BinaryGraphHeader header = BinaryGraphIO<G>::readHeader(file);
+        G g = makeLoaded_((G*)NULL, header);
+        BinaryGraphIO<G>::load(g, file, header);
+        return g;
+    }
+}
 
 ////////////////////////////////////////////////////////////
-// mincostmaxflow.h
+// io.h
 ////////////////////////////////////////////////////////////
 
-
-namespace sgtl{
-    template <class E, class Weight>
-    void fordBellman(Graph<E>& g, vertex v, std::vector<Weight> &shortest,
-                     std::function<Weight(const E& e)> cost, Weight INF) {
-        shortest.assign(g.vertexCount(), INF);
-        shortest[v] = Weight();
-        bool modified = true;
-        while (modified) {
-            modified = false;
-            for (vertex v = 0; v < g.vertexCount(); ++v) {
-                for (auto e = g.begin(v); e != g.end(v); ++e) {
-                    Weight c = cost(*e);
-                    if ((c != INF) && (shortest[(*e).to()] > shortest[v] + c)) {
-                        shortest[(*e).to()] = shortest[v] + c;
-                        modified = true;
-                    }
+namespace sgtl {
+namespace io {
+    /// Fast whitespace separated input, a replacement for std::cin >> in the task drivers.
+    /// A regular file on the descriptor is mapped whole, anything else (pipe, tty) is read in blocks.
+    /// Do not mix with std::cin on the same descriptor: the reader takes the input ahead.
+    class Reader {
+    public:
+        explicit Reader(int fd = 0) : fd_(fd), mapped_(NULL), mappedSize_(0), eof_(false) {
+            struct stat st;
+            if ((fstat(fd_, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+                off_t position = lseek(fd_, 0, SEEK_CUR);
+                void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+                if ((position >= 0) && (position <= st.st_size) && (data != MAP_FAILED)) {
+                    madvise(data, st.st_size, MADV_SEQUENTIAL);
+                    mapped_ = static_cast<const char*>(data);
+                    mappedSize_ = st.st_size;
+                    current_ = mapped_ + position;
+                    end_ = mapped_ + mappedSize_;
+                    eof_ = true;
+                    return;
+                }
+                if (data != MAP_FAILED) {
+                    munmap(data, st.st_size);
                 }
             }
+            buffer_.resize(BUFFER_SIZE);
+            current_ = end_ = buffer_.data();
         }
-    }
 
+        ~Reader() {
+            if (mapped_) {
+                munmap(const_cast<char*>(mapped_), mappedSize_);
+            }
+        }
 
-    template <class EdgeCostFlow>
-    bool dfsPushMinCostFlow(Network<EdgeCostFlow>& g, vertex v, const std::vector<cost_t>& shortest,
-                            std::function<cost_t(const EdgeCostFlow& e)>& cost, std::vector<cost_t>& order) {
-        order[v] = 1;
-        if (v == g.getTarget()) {
-            return true;
+        /// Skips whitespace, false if nothing but whitespace is left
+        bool hasNext() {
+            while (true) {
+                while ((current_ < end_) && ((unsigned char)*current_ <= ' ')) {
+                    ++current_;
+                }
+                if ((current_ < end_) || eof_) {
+                    break;
+                }
+                refill_();
+            }
+            return current_ < end_;
         }
-        for (auto e = g.begin(v); e != g.end(v); ++e) {
-            if ((*e).unsaturated() && (!order[(*e).to()])
-                    && (shortest[v] + cost(*e) == shortest[(*e).to()]) ) {
-                if (dfsPushMinCostFlow(g, (*e).to(), shortest, cost, order)) {
-                    e.pushFlow(1);
-                    return true;
+
+        /// Like std::cin >> value, but a token without digits or a value that does not fit into T
+        /// throws (std::runtime_error, std::overflow_error) instead of setting failbit;
+        /// the bad token is skipped first, so reading can go on after the exception
+        template <class T>
+        T readInt() {
+            static_assert(std::is_integral<T>::value, "io:: readInt() needs an integer type");
+            if (!hasNext()) {
+                throw std::runtime_error("io:: unexpected end of input");
+            }
+            bool negative = (*current_ == '-');
+            if (negative || (*current_ == '+')) {
+                ++current_;
+            }
+            /// The largest magnitude that still fits, -min() of a signed T goes through min() + 1
+            uint64_t limit = negative
+                ? (std::is_signed<T>::value ? (uint64_t)(-(std::numeric_limits<T>::min() + 1)) + 1 : 0)
+                : (uint64_t)std::numeric_limits<T>::max();
+            bool digits = false;
+            uint64_t value = 0;
+            /// A token that runs into the end of the buffer continues after a refill
+            while (true) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+                while (end_ - current_ >= 8) {
+                    uint64_t chunk;
+                    memcpy(&chunk, current_, 8);
+                    if (!eightDigits_(chunk)) {
+                        break;
+                    }
+                    uint64_t part = parseEightDigits_(chunk);
+                    if ((part > limit) || (value > (limit - part) / 100000000)) {
+                        skipToken_();
+                        throw std::overflow_error("io:: integer overflow");
+                    }
+                    value = value * 100000000 + part;
+                    current_ += 8;
+                    digits = true;
+                }
+#endif
+                while ((current_ < end_) && ((unsigned char)(*current_ - '0') < 10)) {
+                    uint64_t digit = *current_ - '0';
+                    if ((digit > limit) || (value > (limit - digit) / 10)) {
+                        skipToken_();
+                        throw std::overflow_error("io:: integer overflow");
+                    }
+                    value = value * 10 + digit;
+                    ++current_;
+                    digits = true;
+                }
+                if ((current_ < end_) || eof_) {
+                    break;
                 }
+                refill_();
+            }
+            if (!digits) {
+                skipToken_();
+                throw std::runtime_error("io:: integer expected");
             }
+            return negative ? (T)(0 - value) : (T)value;
         }
-        return false;
-    }
 
-    template<class EdgeCostFlow>
-    void dfsPushMinCostFlow(Network<EdgeCostFlow>& g, const std::vector<cost_t>& shortest,
-                            std::function<cost_t(const EdgeCostFlow& e)>& cost) {
-        std::vector<cost_t> order(g.vertexCount());
-        dfsPushMinCostFlow(g, g.getSource(), shortest, cost, order);
-    }
+        /// Reads count integers into out
+        template <class T>
+        void readInts(T* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = readInt<T>();
+            }
+        }
 
-    template<class EdgeCostFlow>
-    void minCostMaxFlow(Network<EdgeCostFlow>& g, flow_t& flow, cost_t& cost, cost_t INF) {
-        std::vector<cost_t> p;
-        std::vector<cost_t> shortest;
-        flow = cost = 0;
-        std::function<cost_t(const EdgeCostFlow& e)> costFBLambda = [&p, INF](const EdgeCostFlow& e) -> cost_t {
-            if (e.unsaturated()) {
-                return e.cost();
-            } else {
-                return INF;
+        /// Reads a rows x cols matrix into matrix[shift + i][shift + j],
+        /// shift = 1 gives the 1-based layout of the Hungarian algorithm code
+        template <class T>
+        void readMatrix(std::vector<std::vector<T>>& matrix, size_t rows, size_t cols, size_t shift = 0) {
+            matrix.resize(rows + shift);
+            for (size_t i = 0; i < rows + shift; ++i) {
+                matrix[i].resize(cols + shift);
             }
-        };
-        fordBellman<EdgeCostFlow, cost_t>(g, g.getSource(), p, costFBLambda, INF);
-        std::function<cost_t(const EdgeCostFlow& e)> costDLambda = [&p, INF](const EdgeCostFlow& e) -> cost_t {
-            if (e.unsaturated()) {
-                return (int)(p[e.from()] - p[e.to()] + e.cost());
-            } else {
-                return INF;
+            for (size_t i = 0; i < rows; ++i) {
+                readInts(matrix[i + shift].data() + shift, cols);
             }
-        };
+        }
 
-        while (true) {
-            dijkstra<EdgeCostFlow, cost_t>(g, g.getSource(), shortest, costDLambda,  INF);
-            if (shortest[g.getTarget()] == INF) {
-                break;
+        /// Reads count edges as "from to [capacity [cost]]", the fields depend on E;
+        /// first is the number of the first vertex in the input (1 for 1-based input)
+        template <class E>
+        void readEdges(std::vector<E>& edges, size_t count, size_t first = 0) {
+            const int fields = E::hasCost ? 4 : (E::hasFlow ? 3 : 2);
+            edges.reserve(edges.size() + count);
+            for (size_t i = 0; i < count; ++i) {
+                edges.push_back(readEdge_<E>(std::integral_constant<int, fields>(), first));
             }
-            dfsPushMinCostFlow(g, shortest, costDLambda);
-            flow += 1;
-            cost += (shortest[g.getTarget()] + p[g.getTarget()] - p[g.getSource()]);
+        }
+
+        Reader& operator>>(char& c) {
+            if (!hasNext()) {
+                throw std::runtime_error("io:: unexpected end of input");
+            }
+            c = *current_++;
+            return *this;
+        }
+
+        Reader& operator>>(std::string& s) {
+            if (!hasNext()) {
+                throw std::runtime_error("io:: unexpected end of input");
+            }
+            s.clear();
+            while (true) {
+                const char* start = current_;
+                while ((current_ < end_) && ((unsigned char)*current_ > ' ')) {
+                    ++current_;
+                }
+                s.append(start, current_);
+                if ((current_ < end_) || eof_) {
+                    break;
+                }
+                refill_();
+            }
+            return *this;
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_integral<T>::value, Reader&>::type operator>>(T& value) {
+            value = readInt<T>();
+            return *this;
+        }
+
+    private:
+        Reader(const Reader&);
+        Reader& operator=(const Reader&);
+
+        static const size_t BUFFER_SIZE = 1 << 16;
+
+        int fd_;
+        const char* mapped_;
+        size_t mappedSize_;
+        std::vector<char> buffer_;
+        const char* current_;
+        const char* end_;
+        bool eof_;
+
+        void skipToken_() {
+            while (true) {
+                while ((current_ < end_) && ((unsigned char)*current_ > ' ')) {
+                    ++current_;
+                }
+                if ((current_ < end_) || eof_) {
+                    break;
+                }
+                refill_();
+            }
+        }
+
+        /// Moves the unread tail to the front of the buffer and reads more. A single read(),
+        /// so a pipe or a tty hands out what the writer has sent so far instead of blocking
+        void refill_() {
+            size_t left = end_ - current_;
+            memmove(buffer_.data(), current_, left);
+            current_ = buffer_.data();
+            end_ = buffer_.data() + left;
+            if (left == buffer_.size()) {
+                return;
+            }
+            ssize_t got = read(fd_, buffer_.data() + left, buffer_.size() - left);
+            if (got < 0) {
+                throw std::runtime_error("io:: read failed");
+            }
+            if (got == 0) {
+                eof_ = true;
+            }
+            end_ += got;
+        }
+
+        static bool eightDigits_(uint64_t chunk) {
+            return ((chunk & 0xF0F0F0F0F0F0F0F0ULL)
+                    | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+        }
+
+        static uint64_t parseEightDigits_(uint64_t chunk) {
+            const uint64_t mask = 0x000000FF000000FFULL;
+            const uint64_t mul1 = 100 + (1000000ULL << 32);
+            const uint64_t mul2 = 1 + (10000ULL << 32);
+            chunk -= 0x3030303030303030ULL;
+            chunk = (chunk * 10) + (chunk >> 8);
+            return (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+        }
+
+        /// Vertex number shifted by first, the result must fit into V
+        template <class V>
+        V readVertex_(size_t first) {
+            size_t value = readInt<size_t>();
+            if (value < first) {
+                throw std::runtime_error("io:: vertex number below the first vertex");
+            }
+            return checkedCast<V>(value - first, "io:: vertex number overflow");
+        }
+
+        template <class E>
+        E readEdge_(std::integral_constant<int, 2>, size_t first) {
+            typename E::vertex_type from = readVertex_<typename E::vertex_type>(first);
+            typename E::vertex_type to = readVertex_<typename E::vertex_type>(first);
+            return E(from, to);
+        }
+
+        template <class E>
+        E readEdge_(std::integral_constant<int, 3>, size_t first) {
+            typename E::vertex_type from = readVertex_<typename E::vertex_type>(first);
+            typename E::vertex_type to = readVertex_<typename E::vertex_type>(first);
+            flow_t capacity = readInt<flow_t>();
+            return E(from, to, capacity);
+        }
+
+        template <class E>
+        E readEdge_(std::integral_constant<int, 4>, size_t first) {
+            typename E::vertex_type from = readVertex_<typename E::vertex_type>(first);
+            typename E::vertex_type to = readVertex_<typename E::vertex_type>(first);
+            flow_t capacity = readInt<flow_t>();
+            cost_t cost = readInt<cost_t>();
+            return E(from, to, capacity, cost);
+        }
+    };
+}
+}
+
+////////////////////////////////////////////////////////////
+// bfs.h
+////////////////////////////////////////////////////////////
+
+#include <queue>
+
+namespace sgtl {
+    class DFS {
+    public:
+        static void dfs(vertex v, Graph<Edge> &gr, std::vector<int> &order, int color) {
+            order[v] = color;
+            for (auto e = gr.begin(v); e != gr.end(v); ++e) {
+                if (!order[(*e).to()]) {
+                    dfs((*e).to(), gr, order, color);
+                }
+            }
+        }
+        static void dfsSeries(Graph<Edge> &gr, std::vector<int> &order) {
+            order.assign(gr.vertexCount(), 0);
+            for (vertex i = 0; i < gr.vertexCount(); ++i) {
+                if (!order[i]) {
+                    dfs(i, gr, order, i + 1);
+                }
+            }
+        }
+    private:
+        DFS() { // only static class
+        }
+    };
+
+    /// Edge filter that lets every edge through
+    struct AllEdges {
+        bool operator()(size_t) const {
+            return true;
+        }
+    };
+
+    class BFS {
+    public:
+        /// Levels over edges with residual capacity at least delta, stops once `to` is reached
+        template <class E, template <class> class Store>
+        static void bfsUntil(Graph<E, Store>& g, vertex v, vertex to, std::vector<vertex>& level, flow_t delta = 1) {
+            bfsUntil(g, v, to, level, delta, AllEdges());
+        }
+
+        /// Same over the edges with filter(id) == true only
+        template <class E, template <class> class Store, class Filter>
+        static void bfsUntil(Graph<E, Store>& g, vertex v, vertex to, std::vector<vertex>& level, flow_t delta,
+                             Filter filter) {
+            if (!g.isVertex(v)) {
+                throw std::runtime_error("bsf :: vertex out of bounds");
+            }
+            level.assign(g.vertexCount(), 0);
+            level[v] = 1;
+
+            std::queue <vertex> qq;
+            qq.push(v);
+
+            while (!qq.empty() && (level[to] == 0)) {
+                v = qq.front();
+                qq.pop();
+
+                for (auto id : g.neighbors(v)) {
+                    vertex u = g.to(id);
+                    if ((level[u] == 0) && (g.residualCapacity(id) >= delta) && filter(id)) {
+                        level[u] = level[v] + 1;
+                        qq.push(u);
+                    }
+                }
+            }
+        }
+    private:
+        BFS() { // only static class
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////
+// flow.h
+////////////////////////////////////////////////////////////
+
+namespace sgtl {
+    /// Solver objects own their scratch buffers and reuse them from run to run;
+    /// one solver per thread, any number of solvers at once. clear() gives the memory back.
+    template<class Network>
+    class DinitzSolver {
+    public:
+        /// With capacityScaling phases only use edges of residual at least delta, halving delta
+        /// from the largest residual down to 1; fewer, fatter augmentations on wide capacity ranges
+        flow_t run(Network& g, bool capacityScaling = false) {
+            return getMaxFlow_(g, g.getSource(), g.getTarget(), MAX_FLOW, capacityScaling, AllEdges());
+        }
+
+        /// Pushes at most limit more flow from one vertex to another over the residual network,
+        /// returns how much was pushed
+        flow_t run(Network& g, vertex from, vertex to, flow_t limit) {
+            return getMaxFlow_(g, from, to, limit, false, AllEdges());
+        }
+
+        /// Same over the subnetwork of edges with filter(id) == true
+        template <class Filter>
+        flow_t run(Network& g, vertex from, vertex to, flow_t limit, Filter filter) {
+            return getMaxFlow_(g, from, to, limit, false, filter);
+        }
+
+        void clear() {
+            std::vector<vertex>().swap(level_);
+            std::vector<size_t>().swap(ptr_);
+            std::vector<edge_id_type>().swap(path_);
+        }
+
+    private:
+        typedef typename Network::edge_id_type edge_id_type;
+
+        std::vector<vertex> level_;
+        std::vector<size_t> ptr_;
+        std::vector<edge_id_type> path_;
+
+        template <class Filter>
+        flow_t getMaxFlow_(Network& g, vertex source, vertex target, flow_t limit, bool capacityScaling,
+                           Filter filter) {
+            flow_t flow = 0;
+            flow_t delta = 1;
+            if (capacityScaling) {
+                flow_t maxResidual = 0;
+                for (size_t id = 0; id < g.edgesCount(); ++id) {
+                    maxResidual = std::max(maxResidual, g.residualCapacity(id));
+                }
+                while (delta <= maxResidual / 2) {
+                    delta *= 2;
+                }
+            }
+
+            for (; delta > 0; delta /= 2) {
+                while ((flow < limit) && (source != target)) {
+                    BFS::bfsUntil(g, source, target, level_, delta, filter);
+                    if (level_[target] == 0) {
+                        break;
+                    }
+                    ptr_.assign(g.vertexCount(), 0);
+                    flow += blockingFlow_(g, source, target, limit - flow, delta, filter);
+                }
+            }
+            return flow;
+        }
+
+        /// Iterative DFS over the level graph with an explicit stack of edges. After an augmentation
+        /// only the part of the path behind the first saturated edge is dropped, so the prefix is reused.
+        template <class Filter>
+        flow_t blockingFlow_(Network& g, vertex source, vertex target, flow_t limit, flow_t delta, Filter filter) {
+            flow_t flow = 0;
+            path_.clear();
+            vertex v = source;
+            while (flow < limit) {
+                if (v == target) {
+                    flow_t push = limit - flow;
+                    for (size_t i = 0; i < path_.size(); ++i) {
+                        push = std::min(push, g.residualCapacity(path_[i]));
+                    }
+                    size_t saturated = path_.size();
+                    for (size_t i = 0; i < path_.size(); ++i) {
+                        g.pushFlow(path_[i], push);
+                        if ((saturated == path_.size()) && (g.residualCapacity(path_[i]) < delta)) {
+                            saturated = i;
+                        }
+                    }
+                    flow += push;
+                    if (saturated == path_.size()) {
+                        break;
+                    }
+                    v = g.from(path_[saturated]);
+                    path_.resize(saturated);
+                    continue;
+                }
+
+                auto edges = g.neighbors(v);
+                while (ptr_[v] < edges.size()) {
+                    auto id = edges[ptr_[v]];
+                    if ((level_[g.to(id)] == level_[v] + 1) && (g.residualCapacity(id) >= delta) && filter(id)) {
+                        break;
+                    }
+                    ++ptr_[v];
+                }
+                if (ptr_[v] < edges.size()) {
+                    auto id = edges[ptr_[v]];
+                    path_.push_back(id);
+                    v = g.to(id);
+                } else {
+                    /// Dead end: nothing from v reaches the target in this phase
+                    level_[v] = 0;
+                    if (path_.empty()) {
+                        break;
+                    }
+                    v = g.from(path_.back());
+                    path_.pop_back();
+                    ++ptr_[v];
+                }
+            }
+            return flow;
+        }
+
+    };
+
+    template<class Network>
+    class Dinitz {
+    public:
+        static flow_t getMaxFlow(Network& g, bool capacityScaling = false) {
+            return DinitzSolver<Network>().run(g, capacityScaling);
+        }
+        static flow_t getFlow(Network& g, vertex from, vertex to, flow_t limit) {
+            return DinitzSolver<Network>().run(g, from, to, limit);
+        }
+    private:
+        Dinitz() { // only static class
+        }
+    };
+
+    /// Highest-label push-relabel with gap and global relabelling, an alternative to Dinitz
+    /// for dense and deep networks. Phase 1 builds a maximum preflow, phase 2 sends the excess
+    /// that cannot reach the target back to the source, so the network ends up with a valid flow.
+    /// Like Dinitz, starts from the current flow and returns how much was added.
+    /// Initial preflow of push-relabel: saturates the source edges, but pushes into a vertex no more
+    /// than can leave it, and into the target no more than can enter it. The bounds do not change
+    /// the maximum flow, and with them MAX_FLOW ("infinite") capacities do not overflow the excesses
+    template <class Network>
+    void saturateSource_(Network& g, std::vector<flow_t>& excess) {
+        auto add = [](flow_t sum, flow_t value) {
+            return (sum > MAX_FLOW - value) ? MAX_FLOW : sum + value;
+        };
+        vertex s = g.getSource();
+        vertex t = g.getTarget();
+        std::vector<flow_t> room(g.vertexCount(), -1);
+        for (auto id : g.neighbors(s)) {
+            vertex v = g.to(id);
+            if (room[v] < 0) {
+                room[v] = 0;
+                for (auto other : g.neighbors(v)) {
+                    if (v == t) {
+                        room[v] = add(room[v], g.residualCapacity(other ^ 1));
+                    } else if (v != s) {
+                        room[v] = add(room[v], g.residualCapacity(other));
+                    }
+                }
+            }
+            flow_t pushed = std::min(g.residualCapacity(id), room[v]);
+            if (pushed > 0) {
+                g.pushFlow(id, pushed);
+                room[v] -= pushed;
+                excess[s] -= pushed;
+                excess[v] += pushed;
+            }
+        }
+    }
+
+    template<class Network>
+    class PushRelabelSolver {
+    public:
+        flow_t run(Network& g) {
+            return getMaxFlow_(g);
+        }
+
+        void clear() {
+            std::vector<size_t>().swap(height_);
+            std::vector<flow_t>().swap(excess_);
+            std::vector<size_t>().swap(current_);
+            std::vector<std::vector<vertex>>().swap(active_);
+            std::vector<vertex>().swap(bucketHead_);
+            std::vector<vertex>().swap(bucketNext_);
+            std::vector<vertex>().swap(bucketPrev_);
+            std::vector<vertex>().swap(queue_);
+        }
+
+    private:
+        vertex sink_;
+        vertex other_;
+        size_t limit_;
+        bool gaps_;
+        size_t relabels_;
+        size_t maxActive_;
+        size_t maxHeight_;
+
+        std::vector<size_t> height_;
+        std::vector<flow_t> excess_;
+        std::vector<size_t> current_;
+        std::vector<std::vector<vertex>> active_;
+        std::vector<vertex> bucketHead_;    /// all vertices of every height below limit_, for gaps
+        std::vector<vertex> bucketNext_;
+        std::vector<vertex> bucketPrev_;
+        std::vector<vertex> queue_;
+
+        flow_t getMaxFlow_(Network& g) {
+            size_t n = g.vertexCount();
+            vertex s = g.getSource();
+            vertex t = g.getTarget();
+            if (s == t) {
+                return 0;
+            }
+            excess_.assign(n, 0);
+            current_.resize(n);
+            bucketNext_.resize(n);
+            bucketPrev_.resize(n);
+            saturateSource_(g, excess_);
+
+            run_(g, t, s, n, true);
+            flow_t flow = excess_[t];
+            run_(g, s, t, 2 * n, false);
+            return flow;
+        }
+
+        /// Discharges active vertices of height below limit towards sink, highest first
+        void run_(Network& g, vertex sink, vertex other, size_t limit, bool gaps) {
+            sink_ = sink;
+            other_ = other;
+            limit_ = limit;
+            gaps_ = gaps;
+            globalRelabel_(g);
+            while (true) {
+                while ((maxActive_ > 0) && active_[maxActive_].empty()) {
+                    --maxActive_;
+                }
+                if (active_[maxActive_].empty()) {
+                    break;
+                }
+                vertex v = active_[maxActive_].back();
+                active_[maxActive_].pop_back();
+                if ((excess_[v] == 0) || (height_[v] != maxActive_)) {
+                    continue;
+                }
+                discharge_(g, v);
+                if (relabels_ >= g.vertexCount()) {
+                    globalRelabel_(g);
+                }
+            }
+        }
+
+        void discharge_(Network& g, vertex v) {
+            auto edges = g.neighbors(v);
+            while (excess_[v] > 0) {
+                if (current_[v] == edges.size()) {
+                    relabel_(g, v);
+                    if (height_[v] >= limit_) {
+                        return;
+                    }
+                    continue;
+                }
+                auto id = edges[current_[v]];
+                vertex u = g.to(id);
+                flow_t residual = g.residualCapacity(id);
+                if ((residual > 0) && (height_[v] == height_[u] + 1)) {
+                    flow_t pushed = g.pushFlow(id, std::min(excess_[v], residual));
+                    excess_[v] -= pushed;
+                    bool wasActive = excess_[u] > 0;
+                    excess_[u] += pushed;
+                    if (!wasActive && (u != sink_)) {
+                        activate_(u);
+                    }
+                } else {
+                    ++current_[v];
+                }
+            }
+        }
+
+        void relabel_(Network& g, vertex v) {
+            ++relabels_;
+            size_t old = height_[v];
+            size_t height = limit_;
+            for (auto id : g.neighbors(v)) {
+                if (g.residualCapacity(id) > 0) {
+                    height = std::min(height, height_[g.to(id)] + 1);
+                }
+            }
+            removeFromBucket_(v);
+            if (gaps_ && (bucketHead_[old] == NO_VERTEX)) {
+                /// Nobody is left at height old: everything above is cut off from the sink
+                for (size_t h = old + 1; h <= maxHeight_; ++h) {
+                    for (vertex u = bucketHead_[h]; u != NO_VERTEX; u = bucketNext_[u]) {
+                        height_[u] = limit_;
+                    }
+                    bucketHead_[h] = NO_VERTEX;
+                }
+                maxHeight_ = old;
+                height_[v] = limit_;
+                return;
+            }
+            height_[v] = height;
+            current_[v] = 0;
+            if (height < limit_) {
+                addToBucket_(v);
+            }
+        }
+
+        /// Exact distances to the sink by reverse BFS over residual edges
+        void globalRelabel_(Network& g) {
+            size_t n = g.vertexCount();
+            relabels_ = 0;
+            height_.assign(n, limit_);
+            bucketHead_.assign(limit_ + 1, NO_VERTEX);
+            active_.resize(limit_ + 1);
+            for (size_t h = 0; h < active_.size(); ++h) {
+                active_[h].clear();
+            }
+            maxActive_ = 0;
+            maxHeight_ = 0;
+
+            queue_.clear();
+            queue_.push_back(sink_);
+            height_[sink_] = 0;
+            for (size_t head = 0; head < queue_.size(); ++head) {
+                vertex v = queue_[head];
+                for (auto id : g.neighbors(v)) {
+                    vertex u = g.to(id);
+                    if ((height_[u] == limit_) && (u != other_) && (g.residualCapacity(id ^ 1) > 0)) {
+                        height_[u] = height_[v] + 1;
+                        queue_.push_back(u);
+                    }
+                }
+            }
+            for (size_t i = 1; i < queue_.size(); ++i) {
+                vertex v = queue_[i];
+                current_[v] = 0;
+                addToBucket_(v);
+                if (excess_[v] > 0) {
+                    activate_(v);
+                }
+            }
+        }
+
+        void activate_(vertex v) {
+            if ((excess_[v] > 0) && (height_[v] < limit_)) {
+                active_[height_[v]].push_back(v);
+                maxActive_ = std::max(maxActive_, height_[v]);
+            }
+        }
+
+        void addToBucket_(vertex v) {
+            size_t h = height_[v];
+            bucketPrev_[v] = NO_VERTEX;
+            bucketNext_[v] = bucketHead_[h];
+            if (bucketHead_[h] != NO_VERTEX) {
+                bucketPrev_[bucketHead_[h]] = v;
+            }
+            bucketHead_[h] = v;
+            maxHeight_ = std::max(maxHeight_, h);
+        }
+
+        void removeFromBucket_(vertex v) {
+            if (bucketPrev_[v] != NO_VERTEX) {
+                bucketNext_[bucketPrev_[v]] = bucketNext_[v];
+            } else {
+                bucketHead_[height_[v]] = bucketNext_[v];
+            }
+            if (bucketNext_[v] != NO_VERTEX) {
+                bucketPrev_[bucketNext_[v]] = bucketPrev_[v];
+            }
+        }
+    };
+
+    template<class Network>
+    class PushRelabel {
+    public:
+        static flow_t getMaxFlow(Network& g) {
+            return PushRelabelSolver<Network>().run(g);
+        }
+    private:
+        PushRelabel() { // only static class
+        }
+    };
+
+    /// Synchronous parallel push-relabel on a ThreadPool. Every round all active vertices push
+    /// at once with frozen heights: an edge (v, w) is admissible only for v, so flows need no locks
+    /// and only incoming excess goes through atomics. Vertices left with excess are relabelled
+    /// after a barrier, global relabelling is a parallel BFS from the sink.
+    /// Same two phases and result as PushRelabel.
+    template<class Network>
+    class ParallelPushRelabelSolver {
+    public:
+        flow_t run(Network& g, ThreadPool& pool) {
+            return getMaxFlow_(g, pool);
+        }
+
+        void clear() {
+            std::vector<std::atomic<size_t>>().swap(height_);
+            std::vector<size_t>().swap(newHeight_);
+            std::vector<flow_t>().swap(excess_);
+            std::vector<std::atomic<flow_t>>().swap(added_);
+            std::vector<std::atomic<size_t>>().swap(stamp_);
+            std::vector<char>().swap(relabel_);
+            std::vector<vertex>().swap(active_);
+            std::vector<std::vector<vertex>>().swap(next_);
+        }
+
+    private:
+        vertex sink_;
+        vertex other_;
+        size_t limit_;
+        size_t round_;
+        size_t relabels_;
+
+        std::vector<std::atomic<size_t>> height_;
+        std::vector<size_t> newHeight_;
+        std::vector<flow_t> excess_;
+        std::vector<std::atomic<flow_t>> added_;
+        std::vector<std::atomic<size_t>> stamp_;     /// round in which the vertex was queued last
+        std::vector<char> relabel_;
+        std::vector<vertex> active_;
+        std::vector<std::vector<vertex>> next_;      /// per worker
+
+        flow_t getMaxFlow_(Network& g, ThreadPool& pool) {
+            size_t n = g.vertexCount();
+            vertex s = g.getSource();
+            vertex t = g.getTarget();
+            if (s == t) {
+                return 0;
+            }
+            std::vector<std::atomic<size_t>>(n).swap(height_);
+            std::vector<std::atomic<flow_t>>(n).swap(added_);
+            std::vector<std::atomic<size_t>>(n).swap(stamp_);
+            newHeight_.assign(n, 0);
+            excess_.assign(n, 0);
+            relabel_.assign(n, 0);
+            next_.resize(pool.size());
+            round_ = 0;
+            for (size_t v = 0; v < n; ++v) {
+                added_[v].store(0, std::memory_order_relaxed);
+                stamp_[v].store(0, std::memory_order_relaxed);
+            }
+            saturateSource_(g, excess_);
+
+            run_(g, pool, t, s, n);
+            flow_t flow = excess_[t] + added_[t].load();
+            run_(g, pool, s, t, 2 * n);
+            return flow;
+        }
+
+        void run_(Network& g, ThreadPool& pool, vertex sink, vertex other, size_t limit) {
+            sink_ = sink;
+            other_ = other;
+            limit_ = limit;
+            size_t n = g.vertexCount();
+            globalRelabel_(g, pool);
+
+            while (!active_.empty()) {
+                ++round_;
+                std::atomic<size_t> relabels(0);
+                pool.parallelFor(active_.size(), [&](size_t i, size_t t) {
+                    push_(g, active_[i], t);
+                }, 64);
+                pool.parallelFor(active_.size(), [&](size_t i, size_t) {
+                    vertex v = active_[i];
+                    if (relabel_[v]) {
+                        newHeight_[v] = minHeight_(g, v);
+                        relabels.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }, 64);
+
+                /// Apply new heights and collect the incoming excess, then build the next round
+                size_t received = 0;
+                for (size_t t = 0; t < next_.size(); ++t) {
+                    received += next_[t].size();
+                }
+                std::vector<vertex> receivers;
+                receivers.reserve(received);
+                for (size_t t = 0; t < next_.size(); ++t) {
+                    receivers.insert(receivers.end(), next_[t].begin(), next_[t].end());
+                    next_[t].clear();
+                }
+                pool.parallelFor(active_.size() + receivers.size(), [&](size_t i, size_t t) {
+                    if (i < active_.size()) {
+                        vertex v = active_[i];
+                        if (relabel_[v]) {
+                            relabel_[v] = 0;
+                            height_[v].store(newHeight_[v], std::memory_order_relaxed);
+                            if ((newHeight_[v] < limit_) && (stamp_[v].exchange(round_) != round_)) {
+                                next_[t].push_back(v);
+                            }
+                        }
+                    } else {
+                        vertex w = receivers[i - active_.size()];
+                        excess_[w] += added_[w].exchange(0, std::memory_order_relaxed);
+                    }
+                });
+                active_.swap(receivers);
+                for (size_t t = 0; t < next_.size(); ++t) {
+                    active_.insert(active_.end(), next_[t].begin(), next_[t].end());
+                    next_[t].clear();
+                }
+                relabels_ += relabels.load();
+                if (relabels_ >= n) {
+                    globalRelabel_(g, pool);
+                }
+            }
+        }
+
+        /// Pushes the excess of v along admissible edges, heights do not change meanwhile
+        void push_(Network& g, vertex v, size_t t) {
+            size_t height = height_[v].load(std::memory_order_relaxed);
+            if ((height >= limit_) || (excess_[v] == 0)) {
+                return;
+            }
+            flow_t excess = excess_[v];
+            for (auto id : g.neighbors(v)) {
+                vertex w = g.to(id);
+                if (height != height_[w].load(std::memory_order_relaxed) + 1) {
+                    continue;
+                }
+                flow_t residual = g.residualCapacity(id);
+                if (residual <= 0) {
+                    continue;
+                }
+                flow_t pushed = g.pushFlow(id, std::min(excess, residual));
+                excess -= pushed;
+                added_[w].fetch_add(pushed, std::memory_order_relaxed);
+                if ((w != sink_) && (stamp_[w].exchange(round_) != round_)) {
+                    next_[t].push_back(w);
+                }
+                if (excess == 0) {
+                    break;
+                }
+            }
+            excess_[v] = excess;
+            relabel_[v] = (excess > 0);
+        }
+
+        size_t minHeight_(Network& g, vertex v) const {
+            size_t height = limit_;
+            for (auto id : g.neighbors(v)) {
+                if (g.residualCapacity(id) > 0) {
+                    height = std::min(height, height_[g.to(id)].load(std::memory_order_relaxed) + 1);
+                }
+            }
+            return height;
+        }
+
+        /// Level-synchronous BFS from the sink over residual edges, then collects active vertices
+        void globalRelabel_(Network& g, ThreadPool& pool) {
+            size_t n = g.vertexCount();
+            relabels_ = 0;
+            pool.parallelFor(n, [&](size_t v, size_t) {
+                height_[v].store(limit_, std::memory_order_relaxed);
+            }, 4096);
+            height_[sink_].store(0);
+            std::vector<vertex> frontier(1, sink_);
+            for (size_t level = 1; !frontier.empty(); ++level) {
+                pool.parallelFor(frontier.size(), [&](size_t i, size_t t) {
+                    for (auto id : g.neighbors(frontier[i])) {
+                        vertex u = g.to(id);
+                        size_t unreached = limit_;
+                        if ((u != other_) && (height_[u].load(std::memory_order_relaxed) == limit_)
+                                && (g.residualCapacity(id ^ 1) > 0)
+                                && height_[u].compare_exchange_strong(unreached, level)) {
+                            next_[t].push_back(u);
+                        }
+                    }
+                }, 64);
+                frontier.clear();
+                for (size_t t = 0; t < next_.size(); ++t) {
+                    frontier.insert(frontier.end(), next_[t].begin(), next_[t].end());
+                    next_[t].clear();
+                }
+            }
+
+            ++round_;
+            pool.parallelFor(n, [&](size_t v, size_t t) {
+                if ((v != sink_) && (v != other_) && (excess_[v] > 0)
+                        && (height_[v].load(std::memory_order_relaxed) < limit_)) {
+                    stamp_[v].store(round_, std::memory_order_relaxed);
+                    next_[t].push_back(v);
+                }
+            }, 4096);
+            active_.clear();
+            for (size_t t = 0; t < next_.size(); ++t) {
+                active_.insert(active_.end(), next_[t].begin(), next_[t].end());
+                next_[t].clear();
+            }
+        }
+    };
+
+    template<class Network>
+    class ParallelPushRelabel {
+    public:
+        static flow_t getMaxFlow(Network& g, ThreadPool& pool) {
+            return ParallelPushRelabelSolver<Network>().run(g, pool);
+        }
+        /// threads = 0 means one per hardware thread
+        static flow_t getMaxFlow(Network& g, size_t threads = 0) {
+            ThreadPool pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+            return getMaxFlow(g, pool);
+        }
+    private:
+        ParallelPushRelabel() { // only static class
+        }
+    };
+
+    /// Solves independent networks on a pool, one Solver (DinitzSolver, PushRelabelSolver) per worker
+    /// so scratch buffers are reused across networks; returns the flow added to every network
+    template<class Network, class Solver = DinitzSolver<Network>>
+    std::vector<flow_t> maxFlowBatch(std::vector<Network*>& networks, ThreadPool& pool) {
+        std::vector<flow_t> flows(networks.size());
+        std::vector<Solver> solvers(pool.size());
+        pool.parallelFor(networks.size(), [&](size_t i, size_t t) {
+            flows[i] = solvers[t].run(*networks[i]);
+        }, 1);
+        return flows;
+    }
+
+    template<class Network, class Solver = DinitzSolver<Network>>
+    std::vector<flow_t> maxFlowBatch(std::vector<Network>& networks, ThreadPool& pool) {
+        std::vector<Network*> pointers;
+        for (size_t i = 0; i < networks.size(); ++i) {
+            pointers.push_back(&networks[i]);
+        }
+        return maxFlowBatch<Network, Solver>(pointers, pool);
+    }
+
+    /// Keeps a maximum flow of a network up to date while capacities change.
+    /// A capacity cut below the current flow is repaired locally: the surplus is rerouted
+    /// around the edge, what does not fit goes back to the source and is pulled back from the target.
+    /// getMaxFlow() then continues Dinitz from the repaired flow instead of starting from zero.
+    template<class Network>
+    class IncrementalMaxFlow {
+    public:
+        /// The network may already carry a (valid) flow, it is kept
+        explicit IncrementalMaxFlow(Network& g) : g_(g), flow_(0) {
+            for (auto id : g_.neighbors(g_.getSource())) {
+                flow_ += g_.flow(id);
+            }
+        }
+
+        /// Augments the current flow to a maximum one and returns its value
+        flow_t getMaxFlow() {
+            flow_ += solver_.run(g_);
+            return flow_;
+        }
+
+        /// Value of the current flow, maximal only right after getMaxFlow()
+        flow_t getFlow() const {
+            return flow_;
+        }
+
+        void setCapacity(size_t id, flow_t capacity) {
+            if (capacity < 0) {
+                throw std::runtime_error("IncrementalMaxFlow:: negative capacity");
+            }
+            flow_t excess = g_.flow(id) - capacity;
+            g_.pushCapacity(id, capacity - g_.capacity(id));
+            if (excess > 0) {
+                g_.pushFlow(id, (flow_t)0 - excess);
+                repair_(g_.from(id), g_.to(id), excess);
+            }
+        }
+
+        void pushCapacity(size_t id, flow_t delta) {
+            setCapacity(id, g_.capacity(id) + delta);
+        }
+
+        /// Edge ids are kept, the edge and its pair id ^ 1 just get zero capacity
+        void removeEdge(size_t id) {
+            setCapacity(id, 0);
+            setCapacity(id ^ 1, 0);
+        }
+
+    private:
+        Network& g_;
+        flow_t flow_;
+        DinitzSolver<Network> solver_;
+
+        /// u got excess more inflow than outflow and v the same lack
+        void repair_(vertex u, vertex v, flow_t excess) {
+            if (u == v) {
+                return;
+            }
+            excess -= solver_.run(g_, u, v, excess);
+            if (excess == 0) {
+                return;
+            }
+            if (u != g_.getSource()) {
+                solver_.run(g_, u, g_.getSource(), excess);
+            }
+            if (v != g_.getTarget()) {
+                solver_.run(g_, g_.getTarget(), v, excess);
+            }
+            flow_ -= excess;
+        }
+    };
+
+    /// Gomory-Hu cut tree of an undirected network by Gusfield's algorithm: n - 1 max flows on the
+    /// original graph, no contractions. Every even edge id u - v of capacity c is an undirected edge
+    /// (back edges add nothing). The flows run speculatively in batches of pool.size(): the cut for
+    /// s is computed against the current parent t, and is kept if parent[s] is still t when the batch
+    /// is applied in order; otherwise s goes to the next batch. minCut(u, v) is the lightest edge of
+    /// the tree path, O(log n) by binary lifting.
+    template<class Network>
+    class GomoryHuTree {
+    public:
+        GomoryHuTree(Network& g, ThreadPool& pool) {
+            build_(g, pool);
+        }
+
+        /// threads = 0 means one per hardware thread
+        explicit GomoryHuTree(Network& g, size_t threads = 1) {
+            ThreadPool pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+            build_(g, pool);
+        }
+
+        size_t vertexCount() const {
+            return parent_.size();
+        }
+
+        /// Tree parent of v, NO_VERTEX for the root (vertex 0)
+        vertex parent(vertex v) const {
+            checkVertex_(v);
+            return parent_[v];
+        }
+
+        /// Min cut between v and its tree parent
+        flow_t parentCut(vertex v) const {
+            checkVertex_(v);
+            return cut_[v];
+        }
+
+        /// Value of the minimum u - v cut, MAX_FLOW for u == v
+        flow_t minCut(vertex u, vertex v) const {
+            checkVertex_(u);
+            checkVertex_(v);
+            flow_t result = MAX_FLOW;
+            if (depth_[u] < depth_[v]) {
+                std::swap(u, v);
+            }
+            for (size_t k = up_.size(); k-- > 0; ) {
+                if (depth_[u] - depth_[v] >= ((size_t)1 << k)) {
+                    result = std::min(result, lightest_[k][u]);
+                    u = up_[k][u];
+                }
+            }
+            if (u == v) {
+                return result;
+            }
+            for (size_t k = up_.size(); k-- > 0; ) {
+                if (up_[k][u] != up_[k][v]) {
+                    result = std::min(result, std::min(lightest_[k][u], lightest_[k][v]));
+                    u = up_[k][u];
+                    v = up_[k][v];
+                }
+            }
+            return std::min(result, std::min(cut_[u], cut_[v]));
+        }
+
+    private:
+        typedef typename Network::edge_type E;
+
+        std::vector<vertex> parent_;
+        std::vector<flow_t> cut_;
+        std::vector<size_t> depth_;
+        std::vector<std::vector<vertex>> up_;
+        std::vector<std::vector<flow_t>> lightest_;
+
+        void checkVertex_(vertex v) const {
+            if (v >= parent_.size()) {
+                throw std::runtime_error("GomoryHuTree:: vertex out of bounds");
+            }
+        }
+
+        struct Worker {
+            Network g;
+            DinitzSolver<Network> solver;
+            std::vector<vertex> queue;
+            explicit Worker(Network&& g) : g(std::move(g)) {
+            }
+        };
+
+        /// Min s - t cut in the worker's copy: side[v] = 1 for the vertices left with s
+        static flow_t minCut_(Worker& worker, vertex s, vertex t, std::vector<char>& side) {
+            Network& g = worker.g;
+            flow_t flow = worker.solver.run(g, s, t, MAX_FLOW);
+            side.assign(g.vertexCount(), 0);
+            side[s] = 1;
+            worker.queue.assign(1, s);
+            for (size_t head = 0; head < worker.queue.size(); ++head) {
+                for (auto id : g.neighbors(worker.queue[head])) {
+                    vertex u = g.to(id);
+                    if (!side[u] && (g.residualCapacity(id) > 0)) {
+                        side[u] = 1;
+                        worker.queue.push_back(u);
+                    }
+                }
+            }
+            for (size_t id = 0; id < g.edgesCount(); id += 2) {
+                if (g.flow(id) > 0) {
+                    g.pushFlow(id ^ 1, g.flow(id));
+                }
+            }
+            return flow;
+        }
+
+        void build_(Network& g, ThreadPool& pool) {
+            size_t n = g.vertexCount();
+            parent_.assign(n, 0);
+            cut_.assign(n, MAX_FLOW);
+            if (n > 0) {
+                parent_[0] = NO_VERTEX;
+            }
+            if (n > 1) {
+                std::vector<E> edges;
+                for (size_t id = 0; id < g.edgesCount(); id += 2) {
+                    EdgeFields fields;
+                    g.edge(id).saveFields(fields);
+                    fields.flow = 0;
+                    edges.push_back(E(fields));
+                    std::swap(fields.from, fields.to);
+                    edges.push_back(E(fields));
+                }
+                std::vector<Worker> workers;
+                workers.reserve(pool.size());
+                for (size_t t = 0; t < pool.size(); ++t) {
+                    workers.push_back(Worker(Network::build(n, 0, 1, edges)));
+                }
+
+                std::vector<vertex> against(pool.size());
+                std::vector<flow_t> flows(pool.size());
+                std::vector<std::vector<char>> sides(pool.size());
+                for (vertex next = 1; next < n; ) {
+                    size_t batch = std::min<size_t>(pool.size(), n - next);
+                    for (size_t i = 0; i < batch; ++i) {
+                        against[i] = parent_[next + i];
+                    }
+                    pool.parallelFor(batch, [&](size_t i, size_t t) {
+                        flows[i] = minCut_(workers[t], next + i, against[i], sides[i]);
+                    }, 1);
+                    for (size_t i = 0; (i < batch) && (parent_[next] == against[i]); ++i, ++next) {
+                        apply_(next, against[i], flows[i], sides[i]);
+                    }
+                }
+            }
+            buildLifting_();
+        }
+
+        /// One step of Gusfield's algorithm with the cut of s against t
+        void apply_(vertex s, vertex t, flow_t flow, const std::vector<char>& side) {
+            cut_[s] = flow;
+            for (vertex v = 0; v < parent_.size(); ++v) {
+                if ((v != s) && side[v] && (parent_[v] == t)) {
+                    parent_[v] = s;
+                }
+            }
+            if ((parent_[t] != NO_VERTEX) && side[parent_[t]]) {
+                parent_[s] = parent_[t];
+                parent_[t] = s;
+                cut_[s] = cut_[t];
+                cut_[t] = flow;
+            }
+        }
+
+        void buildLifting_() {
+            size_t n = parent_.size();
+            std::vector<std::vector<vertex>> children(n);
+            for (vertex v = 0; v < n; ++v) {
+                if (parent_[v] != NO_VERTEX) {
+                    children[parent_[v]].push_back(v);
+                }
+            }
+            depth_.assign(n, 0);
+            std::vector<vertex> order(1, 0);
+            for (size_t head = 0; head < order.size() && n > 0; ++head) {
+                for (auto c : children[order[head]]) {
+                    depth_[c] = depth_[order[head]] + 1;
+                    order.push_back(c);
+                }
+            }
+            size_t levels = 1;
+            while (((size_t)1 << levels) < n) {
+                ++levels;
+            }
+            up_.assign(levels, std::vector<vertex>(n, 0));
+            lightest_.assign(levels, std::vector<flow_t>(n, MAX_FLOW));
+            for (vertex v = 0; v < n; ++v) {
+                up_[0][v] = (parent_[v] != NO_VERTEX) ? parent_[v] : v;
+                lightest_[0][v] = cut_[v];
+            }
+            for (size_t k = 1; k < levels; ++k) {
+                for (vertex v = 0; v < n; ++v) {
+                    vertex middle = up_[k - 1][v];
+                    up_[k][v] = up_[k - 1][middle];
+                    lightest_[k][v] = std::min(lightest_[k - 1][v], lightest_[k - 1][middle]);
+                }
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////
+// dijkstra.h
+////////////////////////////////////////////////////////////
+#include <deque>
+
+namespace sgtl{
+    /// Priority queues for dijkstra(). All of them share one interface: reset(n) before a run,
+    /// push(v, key) inserts v or lowers its key, pop(key) returns a vertex with the smallest key.
+    /// Only DaryHeap really lowers keys, the others keep stale copies, which dijkstra() skips.
+
+    /// Binary heap with lazy deletion, the heap grows to O(E) entries. reset() keeps the memory
+    template <class Weight>
+    class BinaryHeap {
+    public:
+        void reset(size_t) {
+            qq_.clear();
+        }
+        bool empty() const {
+            return qq_.empty();
+        }
+        void push(vertex v, Weight key) {
+            qq_.push_back(std::make_pair(key, v));
+            std::push_heap(qq_.begin(), qq_.end(), std::greater<Entry>());
+        }
+        vertex pop(Weight& key) {
+            std::pop_heap(qq_.begin(), qq_.end(), std::greater<Entry>());
+            key = qq_.back().first;
+            vertex v = qq_.back().second;
+            qq_.pop_back();
+            return v;
+        }
+        /// Like pop(), but the entry stays in the heap
+        vertex top(Weight& key) const {
+            key = qq_.front().first;
+            return qq_.front().second;
+        }
+
+    private:
+        typedef std::pair<Weight, vertex> Entry;
+        std::vector<Entry> qq_;
+    };
+
+    /// Indexed D-ary heap with decrease-key, holds every vertex at most once
+    template <class Weight, size_t D = 4>
+    class DaryHeap {
+    public:
+        /// Only the vertices left in the heap are forgotten, so a reset after a run is cheap
+        void reset(size_t n) {
+            for (auto v : heap_) {
+                pos_[v] = NONE_;
+            }
+            heap_.clear();
+            if (pos_.size() != n) {
+                key_.resize(n);
+                pos_.assign(n, (size_t)NONE_);
+            }
+        }
+        bool empty() const {
+            return heap_.empty();
+        }
+        void push(vertex v, Weight key) {
+            key_[v] = key;
+            if (pos_[v] == NONE_) {
+                pos_[v] = heap_.size();
+                heap_.push_back(v);
+            }
+            siftUp_(pos_[v]);
+        }
+        vertex pop(Weight& key) {
+            vertex v = heap_[0];
+            key = key_[v];
+            pos_[v] = NONE_;
+            vertex last = heap_.back();
+            heap_.pop_back();
+            if (!heap_.empty()) {
+                heap_[0] = last;
+                pos_[last] = 0;
+                siftDown_(0);
+            }
+            return v;
+        }
+
+    private:
+        static const size_t NONE_ = std::numeric_limits<size_t>::max();
+        std::vector<vertex> heap_;
+        std::vector<Weight> key_;
+        std::vector<size_t> pos_;
+
+        void siftUp_(size_t i) {
+            vertex v = heap_[i];
+            while (i > 0) {
+                size_t parent = (i - 1) / D;
+                if (!(key_[v] < key_[heap_[parent]])) {
+                    break;
+                }
+                heap_[i] = heap_[parent];
+                pos_[heap_[i]] = i;
+                i = parent;
+            }
+            heap_[i] = v;
+            pos_[v] = i;
+        }
+
+        void siftDown_(size_t i) {
+            vertex v = heap_[i];
+            while (true) {
+                size_t first = i * D + 1;
+                if (first >= heap_.size()) {
+                    break;
+                }
+                size_t best = first;
+                size_t last = std::min(first + D, heap_.size());
+                for (size_t c = first + 1; c < last; ++c) {
+                    if (key_[heap_[c]] < key_[heap_[best]]) {
+                        best = c;
+                    }
+                }
+                if (!(key_[heap_[best]] < key_[v])) {
+                    break;
+                }
+                heap_[i] = heap_[best];
+                pos_[heap_[i]] = i;
+                i = best;
+            }
+            heap_[i] = v;
+            pos_[v] = i;
+        }
+    };
+
+    /// Monotone radix heap for integer keys: a key may not be less than the last popped one,
+    /// which holds for Dijkstra with non-negative costs. Bucket i keeps keys whose highest bit
+    /// differing from the last popped key is i - 1, so every entry moves O(log C) times.
+    template <class Weight>
+    class RadixHeap {
+        static_assert(std::is_integral<Weight>::value, "RadixHeap:: integer keys only");
+    public:
+        void reset(size_t) {
+            for (auto& bucket : buckets_) {
+                bucket.clear();
+            }
+            last_ = Weight();
+            size_ = 0;
+        }
+        bool empty() const {
+            return size_ == 0;
+        }
+        void push(vertex v, Weight key) {
+            if (key < last_) {
+                throw std::runtime_error("RadixHeap:: key is less than the last popped one");
+            }
+            buckets_[bucket_(key)].push_back(std::make_pair(key, v));
+            ++size_;
+        }
+        vertex pop(Weight& key) {
+            if (buckets_[0].empty()) {
+                size_t i = 1;
+                while (buckets_[i].empty()) {
+                    ++i;
+                }
+                last_ = buckets_[i][0].first;
+                for (auto& entry : buckets_[i]) {
+                    last_ = std::min(last_, entry.first);
+                }
+                for (auto& entry : buckets_[i]) {
+                    buckets_[bucket_(entry.first)].push_back(entry);
+                }
+                buckets_[i].clear();
+            }
+            key = buckets_[0].back().first;
+            vertex v = buckets_[0].back().second;
+            buckets_[0].pop_back();
+            --size_;
+            return v;
+        }
+
+    private:
+        typedef typename std::make_unsigned<Weight>::type Bits;
+        static const size_t BUCKETS_ = sizeof(Weight) * CHAR_BIT + 1;
+        std::vector<std::pair<Weight, vertex>> buckets_[BUCKETS_];
+        Weight last_ = Weight();
+        size_t size_ = 0;
+
+        size_t bucket_(Weight key) const {
+            Bits diff = (Bits)key ^ (Bits)last_;
+            return diff ? sizeof(unsigned long long) * CHAR_BIT - __builtin_clzll(diff) : 0;
+        }
+    };
+
+    /// Dial's bucket queue for small integer costs: a ring of buckets, one per key, that covers
+    /// [last popped key, last popped key + buckets). The ring grows when a key does not fit.
+    template <class Weight>
+    class DialHeap {
+        static_assert(std::is_integral<Weight>::value, "DialHeap:: integer keys only");
+    public:
+        explicit DialHeap(size_t buckets = 64) : buckets_(std::max<size_t>(buckets, 1)) {
+        }
+        void reset(size_t) {
+            for (auto& bucket : buckets_) {
+                bucket.clear();
+            }
+            current_ = Weight();
+            size_ = 0;
+        }
+        bool empty() const {
+            return size_ == 0;
+        }
+        void push(vertex v, Weight key) {
+            if (key < current_) {
+                throw std::runtime_error("DialHeap:: key is less than the last popped one");
+            }
+            if ((size_t)(key - current_) >= buckets_.size()) {
+                grow_((size_t)(key - current_) + 1);
+            }
+            buckets_[(size_t)key % buckets_.size()].push_back(v);
+            ++size_;
+        }
+        vertex pop(Weight& key) {
+            while (buckets_[(size_t)current_ % buckets_.size()].empty()) {
+                ++current_;
+            }
+            auto& bucket = buckets_[(size_t)current_ % buckets_.size()];
+            vertex v = bucket.back();
+            bucket.pop_back();
+            --size_;
+            key = current_;
+            return v;
+        }
+
+    private:
+        std::vector<std::vector<vertex>> buckets_;
+        Weight current_ = Weight();
+        size_t size_ = 0;
+
+        void grow_(size_t needed) {
+            size_t old = buckets_.size();
+            std::vector<std::vector<vertex>> buckets(std::max(needed, 2 * old));
+            for (size_t shift = 0; shift < old; ++shift) {
+                Weight key = current_ + (Weight)shift;
+                buckets[(size_t)key % buckets.size()].swap(buckets_[(size_t)key % old]);
+            }
+            buckets_.swap(buckets);
+        }
+    };
+
+    /// Deque for 0-1 BFS: every pushed key must equal the last popped key or exceed it by one
+    template <class Weight>
+    class ZeroOneHeap {
+    public:
+        void reset(size_t) {
+            qq_.clear();
+            current_ = Weight();
+        }
+        bool empty() const {
+            return qq_.empty();
+        }
+        void push(vertex v, Weight key) {
+            if (key == current_) {
+                qq_.push_front(std::make_pair(key, v));
+            } else if (key == current_ + 1) {
+                qq_.push_back(std::make_pair(key, v));
+            } else {
+                throw std::runtime_error("ZeroOneHeap:: edge costs must be 0 or 1");
+            }
+        }
+        vertex pop(Weight& key) {
+            key = current_ = qq_.front().first;
+            vertex v = qq_.front().second;
+            qq_.pop_front();
+            return v;
+        }
+
+    private:
+        std::deque<std::pair<Weight, vertex>> qq_;
+        Weight current_ = Weight();
+    };
+
+    /// Core of dijkstra(): costById(id) gives the cost of edge id. The callable is a template
+    /// parameter, so the relaxation is inlined
+    template <class E, class Weight, template <class> class Store, class CostById, class Heap>
+    void dijkstraById_(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, CostById costById, Weight INF,
+                       Heap& heap) {
+        shortest.assign(g.vertexCount(), INF);
+        shortest[v] = 0;
+        heap.reset(g.vertexCount());
+        heap.push(v, Weight());
+        while (!heap.empty()) {
+            Weight vCost;
+            vertex v = heap.pop(vCost);
+            if (shortest[v] == vCost) {
+                for (auto id : g.neighbors(v)) {
+                    vertex u = g.to(id);
+                    Weight newCost = vCost + costById(id);
+                    if (shortest[u] > newCost) {
+                        shortest[u] = newCost;
+                        heap.push(u, newCost);
+                    }
+                }
+            }
+        }
+    }
+
+    /// cost(e) is any callable on edges. Heap is one of the queues above; it is reset() here,
+    /// so one object can serve many calls
+    template <class E, class Weight, template <class> class Store, class Cost, class Heap>
+    void dijkstra(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF, Heap& heap) {
+        dijkstraById_(g, v, shortest, [&g, &cost](size_t id) -> Weight { return cost(g.edge(id)); }, INF, heap);
+    }
+
+    template <class E, class Weight, template <class> class Store, class Cost>
+    void dijkstra(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF) {
+        BinaryHeap<Weight> heap;
+        dijkstra(g, v, shortest, cost, INF, heap);
+    }
+
+    /// cost[id] is the precomputed cost of edge id
+    template <class E, class Weight, template <class> class Store, class Heap>
+    void dijkstra(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost, Weight INF,
+                  Heap& heap) {
+        dijkstraById_(g, v, shortest, [&cost](size_t id) { return cost[id]; }, INF, heap);
+    }
+
+    template <class E, class Weight, template <class> class Store>
+    void dijkstra(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost, Weight INF) {
+        BinaryHeap<Weight> heap;
+        dijkstra(g, v, shortest, cost, INF, heap);
+    }
+
+    /// Delta-stepping (Meyer, Sanders) on a pool. Labels live in a ring of buckets of width delta.
+    /// The lowest bucket is emptied by rounds of parallel light edge (cost <= delta) relaxations,
+    /// then the heavy edges of everything settled in it are relaxed once. Labels are lowered by CAS,
+    /// so the result is the same as dijkstra(). Costs must be non-negative. delta = 0 picks
+    /// max cost / average degree.
+    template <class E, class Weight, template <class> class Store, class CostById>
+    void deltaSteppingById_(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, CostById costById, Weight INF,
+                            ThreadPool& pool, Weight delta) {
+        size_t n = g.vertexCount();
+        if (!(delta > Weight())) {
+            std::vector<Weight> maxCost(pool.size(), Weight());
+            pool.parallelFor(n, [&](size_t u, size_t t) {
+                for (auto id : g.neighbors(u)) {
+                    Weight c = costById(id);
+                    if (c != INF) {
+                        maxCost[t] = std::max(maxCost[t], c);
+                    }
+                }
+            }, 1024);
+            Weight top = *std::max_element(maxCost.begin(), maxCost.end());
+            delta = top / (Weight)std::max<size_t>(1, g.edgesCount() / n);
+            if (!(delta > Weight())) {
+                delta = (std::is_integral<Weight>::value || !(top > Weight())) ? Weight(1) : top;
+            }
+        }
+
+        std::vector<std::atomic<Weight>> label(n);
+        pool.parallelFor(n, [&](size_t u, size_t) {
+            label[u].store(INF, std::memory_order_relaxed);
+        }, 4096);
+        label[v].store(Weight());
+
+        std::vector<std::vector<vertex>> buckets(64);
+        size_t first = 0;
+        size_t pending = 0;
+        auto bucketOf = [&label, delta](vertex u) {
+            return (size_t)(label[u].load(std::memory_order_relaxed) / delta);
+        };
+        auto insert = [&](vertex u) {
+            size_t b = bucketOf(u);
+            if (b - first >= buckets.size()) {
+                size_t old = buckets.size();
+                std::vector<std::vector<vertex>> grown(std::max(b - first + 1, 2 * old));
+                for (size_t i = first; i < first + old; ++i) {
+                    grown[i % grown.size()].swap(buckets[i % old]);
+                }
+                buckets.swap(grown);
+            }
+            buckets[b % buckets.size()].push_back(u);
+            ++pending;
+        };
+
+        std::vector<std::vector<vertex>> next(pool.size());
+        auto relax = [&](size_t t, vertex u, bool light) {
+            Weight base = label[u].load(std::memory_order_relaxed);
+            for (auto id : g.neighbors(u)) {
+                Weight c = costById(id);
+                if ((c == INF) || ((c <= delta) != light)) {
+                    continue;
+                }
+                vertex w = g.to(id);
+                Weight candidate = base + c;
+                Weight current = label[w].load(std::memory_order_relaxed);
+                while (candidate < current) {
+                    if (label[w].compare_exchange_weak(current, candidate)) {
+                        next[t].push_back(w);
+                        break;
+                    }
+                }
+            }
+        };
+        auto gather = [&]() {
+            for (size_t t = 0; t < next.size(); ++t) {
+                for (auto w : next[t]) {
+                    insert(w);
+                }
+                next[t].clear();
+            }
+        };
+
+        /// seen[u] is the last light round that took u, settled[u] - 1 the bucket that settled it
+        std::vector<size_t> seen(n, 0);
+        std::vector<size_t> settled(n, 0);
+        std::vector<vertex> frontier;
+        std::vector<vertex> done;
+        size_t round = 0;
+        insert(v);
+        while (pending > 0) {
+            while (buckets[first % buckets.size()].empty()) {
+                ++first;
+            }
+            done.clear();
+            while (!buckets[first % buckets.size()].empty()) {
+                frontier.clear();
+                frontier.swap(buckets[first % buckets.size()]);
+                pending -= frontier.size();
+                ++round;
+                size_t kept = 0;
+                for (auto u : frontier) {
+                    if ((bucketOf(u) == first) && (seen[u] != round)) {
+                        seen[u] = round;
+                        frontier[kept++] = u;
+                        if (settled[u] != first + 1) {
+                            settled[u] = first + 1;
+                            done.push_back(u);
+                        }
+                    }
+                }
+                frontier.resize(kept);
+                pool.parallelFor(frontier.size(), [&](size_t i, size_t t) {
+                    relax(t, frontier[i], true);
+                }, 64);
+                gather();
+            }
+            pool.parallelFor(done.size(), [&](size_t i, size_t t) {
+                relax(t, done[i], false);
+            }, 64);
+            gather();
+        }
+
+        shortest.resize(n);
+        for (vertex u = 0; u < n; ++u) {
+            shortest[u] = label[u].load(std::memory_order_relaxed);
+        }
+    }
+
+    template <class E, class Weight, template <class> class Store, class Cost>
+    void deltaStepping(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF,
+                       ThreadPool& pool, Weight delta = Weight()) {
+        deltaSteppingById_(g, v, shortest, [&g, &cost](size_t id) -> Weight { return cost(g.edge(id)); },
+                           INF, pool, delta);
+    }
+
+    /// cost[id] is the precomputed cost of edge id
+    template <class E, class Weight, template <class> class Store>
+    void deltaStepping(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost,
+                       Weight INF, ThreadPool& pool, Weight delta = Weight()) {
+        deltaSteppingById_(g, v, shortest, [&cost](size_t id) { return cost[id]; }, INF, pool, delta);
+    }
+}
+
+
+namespace sgtl {
+    /// Point-to-point queries on one graph: bidirectional Dijkstra and A*. The reverse adjacency
+    /// is built once, labels are valid only with the current epoch stamp, so a query touches just
+    /// the vertices it reaches. Both stop early and return the path s ... t (empty if unreachable)
+    /// with its length, or INF. Costs must be non-negative.
+    template<class Graph, class Weight>
+    class PointToPointSearch {
+    public:
+        PointToPointSearch(Graph& g, Weight INF) : g_(g), INF_(INF), epoch_(0), settled_(0) {
+            size_t n = g.vertexCount();
+            reverseStart_.assign(n + 1, 0);
+            for (size_t id = 0; id < g.edgesCount(); ++id) {
+                ++reverseStart_[g.to(id) + 1];
+            }
+            for (vertex v = 0; v < n; ++v) {
+                reverseStart_[v + 1] += reverseStart_[v];
+            }
+            reverse_.resize(g.edgesCount());
+            std::vector<size_t> next(reverseStart_.begin(), reverseStart_.end() - 1);
+            for (size_t id = 0; id < g.edgesCount(); ++id) {
+                reverse_[next[g.to(id)]++] = id;
+            }
+            for (size_t side = 0; side < 2; ++side) {
+                stamp_[side].assign(n, 0);
+                label_[side].resize(n);
+                parent_[side].resize(n);
+            }
+            heuristic_.resize(n);
+        }
+
+        template <class Cost>
+        Weight bidirectional(vertex s, vertex t, Cost cost, std::vector<vertex>& path) {
+            return bidirectional_(s, t, [this, &cost](size_t id) -> Weight { return cost(g_.edge(id)); }, path);
+        }
+
+        /// cost[id] is the precomputed cost of edge id
+        Weight bidirectional(vertex s, vertex t, const std::vector<Weight>& cost, std::vector<vertex>& path) {
+            return bidirectional_(s, t, [&cost](size_t id) { return cost[id]; }, path);
+        }
+
+        /// heuristic(v) is a lower bound of the distance from v to t and must be consistent
+        template <class Cost, class Heuristic>
+        Weight astar(vertex s, vertex t, Cost cost, Heuristic heuristic, std::vector<vertex>& path) {
+            return astar_(s, t, [this, &cost](size_t id) -> Weight { return cost(g_.edge(id)); }, heuristic, path);
+        }
+
+        template <class Heuristic>
+        Weight astar(vertex s, vertex t, const std::vector<Weight>& cost, Heuristic heuristic, std::vector<vertex>& path) {
+            return astar_(s, t, [&cost](size_t id) { return cost[id]; }, heuristic, path);
+        }
+
+        /// Vertices settled by the last query
+        size_t settled() const {
+            return settled_;
+        }
+
+    private:
+        static const size_t NONE_ = std::numeric_limits<size_t>::max();
+
+        Graph& g_;
+        Weight INF_;
+        size_t epoch_;
+        size_t settled_;
+        std::vector<size_t> reverseStart_;
+        std::vector<size_t> reverse_;
+        std::vector<size_t> stamp_[2];
+        std::vector<Weight> label_[2];
+        std::vector<size_t> parent_[2];      /// edge id the label came by
+        std::vector<Weight> heuristic_;
+        BinaryHeap<Weight> qq_[2];          /// reset per query, the storage is kept
+
+        Weight labelOf_(size_t side, vertex v) const {
+            return (stamp_[side][v] == epoch_) ? label_[side][v] : INF_;
+        }
+
+        bool setLabel_(size_t side, vertex v, Weight value, size_t id) {
+            if (!(value < labelOf_(side, v))) {
+                return false;
+            }
+            stamp_[side][v] = epoch_;
+            label_[side][v] = value;
+            parent_[side][v] = id;
+            return true;
+        }
+
+        void start_(vertex s, vertex t) {
+            if (!g_.isVertex(s) || !g_.isVertex(t)) {
+                throw std::runtime_error("PointToPointSearch:: vertex out of bounds");
+            }
+            ++epoch_;
+            settled_ = 0;
+            for (size_t side = 0; side < 2; ++side) {
+                qq_[side].reset(g_.vertexCount());
+            }
+        }
+
+        /// Drops stale entries, returns INF if the queue is exhausted
+        Weight top_(size_t side) {
+            Weight key;
+            while (!qq_[side].empty()) {
+                vertex v = qq_[side].top(key);
+                if (key == labelOf_(side, v)) {
+                    return key;
+                }
+                qq_[side].pop(key);
+            }
+            return INF_;
+        }
+
+        /// Walks the forward parents from meet to s and the backward ones from meet to t
+        void buildPath_(vertex s, vertex t, vertex meet, std::vector<vertex>& path) const {
+            path.clear();
+            for (vertex v = meet; v != s; v = g_.from(parent_[0][v])) {
+                path.push_back(v);
+            }
+            path.push_back(s);
+            std::reverse(path.begin(), path.end());
+            for (vertex v = meet; v != t; ) {
+                v = g_.to(parent_[1][v]);
+                path.push_back(v);
+            }
+        }
+
+        template <class CostById>
+        Weight bidirectional_(vertex s, vertex t, CostById costById, std::vector<vertex>& path) {
+            start_(s, t);
+            path.clear();
+            setLabel_(0, s, Weight(), NONE_);
+            setLabel_(1, t, Weight(), NONE_);
+            qq_[0].push(s, Weight());
+            qq_[1].push(t, Weight());
+            Weight best = (s == t) ? Weight() : INF_;
+            vertex meet = s;
+            while (true) {
+                Weight forward = top_(0);
+                Weight backward = top_(1);
+                if ((forward == INF_) || (backward == INF_) || !(forward + backward < best)) {
+                    break;
+                }
+                size_t side = (forward <= backward) ? 0 : 1;
+                Weight base;
+                vertex v = qq_[side].pop(base);
+                ++settled_;
+                size_t first = side ? reverseStart_[v] : 0;
+                size_t last = side ? reverseStart_[v + 1] : 0;
+                auto edges = g_.neighbors(v);
+                size_t count = side ? last - first : edges.size();
+                for (size_t i = 0; i < count; ++i) {
+                    size_t id = side ? reverse_[first + i] : edges[i];
+                    vertex w = side ? g_.from(id) : g_.to(id);
+                    Weight value = base + costById(id);
+                    if (setLabel_(side, w, value, id)) {
+                        qq_[side].push(w, value);
+                    }
+                    Weight other = labelOf_(1 - side, w);
+                    if ((other != INF_) && (labelOf_(side, w) + other < best)) {
+                        best = labelOf_(side, w) + other;
+                        meet = w;
+                    }
+                }
+            }
+            if (best != INF_) {
+                buildPath_(s, t, meet, path);
+            }
+            return best;
+        }
+
+        template <class CostById, class Heuristic>
+        Weight astar_(vertex s, vertex t, CostById costById, Heuristic& heuristic, std::vector<vertex>& path) {
+            start_(s, t);
+            path.clear();
+            setLabel_(0, s, Weight(), NONE_);
+            heuristic_[s] = heuristic(s);
+            qq_[0].push(s, heuristic_[s]);
+            while (!qq_[0].empty()) {
+                Weight key;
+                vertex v = qq_[0].pop(key);
+                if (key != labelOf_(0, v) + heuristic_[v]) {
+                    continue;
+                }
+                ++settled_;
+                if (v == t) {
+                    buildPath_(s, t, t, path);
+                    return labelOf_(0, t);
+                }
+                Weight base = labelOf_(0, v);
+                for (auto id : g_.neighbors(v)) {
+                    vertex w = g_.to(id);
+                    bool known = stamp_[0][w] == epoch_;
+                    if (setLabel_(0, w, base + costById(id), id)) {
+                        if (!known) {
+                            heuristic_[w] = heuristic(w);
+                        }
+                        qq_[0].push(w, label_[0][w] + heuristic_[w]);
+                    }
+                }
+            }
+            return INF_;
+        }
+    };
+
+    /// One-shot A*. Keep a PointToPointSearch for many queries on the same graph
+    template <class E, class Weight, template <class> class Store, class Cost, class Heuristic>
+    Weight shortestPath(Graph<E, Store>& g, vertex s, vertex t, Cost cost, Heuristic heuristic, Weight INF,
+                        std::vector<vertex>& path) {
+        return PointToPointSearch<Graph<E, Store>, Weight>(g, INF).astar(s, t, cost, heuristic, path);
+    }
+
+    /// One-shot bidirectional Dijkstra, builds the reverse adjacency on every call
+    template <class E, class Weight, template <class> class Store, class Cost>
+    Weight shortestPath(Graph<E, Store>& g, vertex s, vertex t, Cost cost, Weight INF, std::vector<vertex>& path) {
+        return PointToPointSearch<Graph<E, Store>, Weight>(g, INF).bidirectional(s, t, cost, path);
+    }
+}
+
+
+namespace sgtl {
+    /// Many-source Dijkstra on one graph and one pool. Every worker owns a heap and a label array;
+    /// a label is valid only with the worker's current epoch stamp, so nothing is cleared between
+    /// sources. Sources are handed out one by one to the workers. Results are those of dijkstra().
+    template<class Graph, class Weight, class Heap = BinaryHeap<Weight>>
+    class ShortestPathEngine {
+    public:
+        ShortestPathEngine(Graph& g, Weight INF, ThreadPool& pool)
+            : g_(g), INF_(INF), pool_(pool), scratch_(pool.size()), target_(g.vertexCount(), 0), targetEpoch_(0) {
+            for (auto& scratch : scratch_) {
+                scratch.stamp.assign(g.vertexCount(), 0);
+                scratch.label.resize(g.vertexCount());
+                scratch.epoch = 0;
+            }
+        }
+
+        /// shortest[i] is what dijkstra() gives for sources[i]
+        template <class Cost>
+        void query(const std::vector<vertex>& sources, Cost cost, std::vector<std::vector<Weight>>& shortest) {
+            query_(sources, [this, &cost](size_t id) -> Weight { return cost(g_.edge(id)); }, shortest);
+        }
+
+        /// cost[id] is the precomputed cost of edge id
+        void query(const std::vector<vertex>& sources, const std::vector<Weight>& cost,
+                   std::vector<std::vector<Weight>>& shortest) {
+            query_(sources, [&cost](size_t id) { return cost[id]; }, shortest);
+        }
+
+        /// table[i][j] is the distance from sources[i] to targets[j]; a search stops as soon as
+        /// all targets are settled
+        template <class Cost>
+        void query(const std::vector<vertex>& sources, const std::vector<vertex>& targets, Cost cost,
+                   std::vector<std::vector<Weight>>& table) {
+            query_(sources, targets, [this, &cost](size_t id) -> Weight { return cost(g_.edge(id)); }, table);
+        }
+
+        void query(const std::vector<vertex>& sources, const std::vector<vertex>& targets,
+                   const std::vector<Weight>& cost, std::vector<std::vector<Weight>>& table) {
+            query_(sources, targets, [&cost](size_t id) { return cost[id]; }, table);
+        }
+
+    private:
+        struct Scratch {
+            Heap heap;
+            std::vector<Weight> label;
+            std::vector<size_t> stamp;
+            size_t epoch;
+        };
+
+        Graph& g_;
+        Weight INF_;
+        ThreadPool& pool_;
+        std::vector<Scratch> scratch_;
+        std::vector<size_t> target_;    /// == targetEpoch_ for the targets of the current query
+        size_t targetEpoch_;
+
+        Weight labelOf_(const Scratch& scratch, vertex v) const {
+            return (scratch.stamp[v] == scratch.epoch) ? scratch.label[v] : INF_;
+        }
+
+        void checkSource_(vertex v) const {
+            if (!g_.isVertex(v)) {
+                throw std::runtime_error("ShortestPathEngine:: vertex out of bounds");
+            }
+        }
+
+        /// Dijkstra from s until the heap is empty or targets distinct targets are settled
+        template <class CostById>
+        void search_(Scratch& scratch, vertex s, CostById& costById, size_t targets) {
+            ++scratch.epoch;
+            scratch.heap.reset(g_.vertexCount());
+            scratch.stamp[s] = scratch.epoch;
+            scratch.label[s] = Weight();
+            scratch.heap.push(s, Weight());
+            while (!scratch.heap.empty()) {
+                Weight vCost;
+                vertex v = scratch.heap.pop(vCost);
+                if (vCost != labelOf_(scratch, v)) {
+                    continue;
+                }
+                if ((targets > 0) && (target_[v] == targetEpoch_) && (--targets == 0)) {
+                    return;
+                }
+                for (auto id : g_.neighbors(v)) {
+                    vertex u = g_.to(id);
+                    Weight newCost = vCost + costById(id);
+                    if (labelOf_(scratch, u) > newCost) {
+                        scratch.stamp[u] = scratch.epoch;
+                        scratch.label[u] = newCost;
+                        scratch.heap.push(u, newCost);
+                    }
+                }
+            }
+        }
+
+        template <class CostById>
+        void query_(const std::vector<vertex>& sources, CostById costById, std::vector<std::vector<Weight>>& shortest) {
+            for (auto s : sources) {
+                checkSource_(s);
+            }
+            shortest.resize(sources.size());
+            pool_.parallelFor(sources.size(), [&](size_t i, size_t t) {
+                Scratch& scratch = scratch_[t];
+                search_(scratch, sources[i], costById, 0);
+                shortest[i].resize(g_.vertexCount());
+                for (vertex v = 0; v < g_.vertexCount(); ++v) {
+                    shortest[i][v] = labelOf_(scratch, v);
+                }
+            }, 1);
+        }
+
+        template <class CostById>
+        void query_(const std::vector<vertex>& sources, const std::vector<vertex>& targets, CostById costById,
+                    std::vector<std::vector<Weight>>& table) {
+            for (auto s : sources) {
+                checkSource_(s);
+            }
+            ++targetEpoch_;
+            size_t distinct = 0;
+            for (auto v : targets) {
+                checkSource_(v);
+                if (target_[v] != targetEpoch_) {
+                    target_[v] = targetEpoch_;
+                    ++distinct;
+                }
+            }
+            table.resize(sources.size());
+            pool_.parallelFor(sources.size(), [&](size_t i, size_t t) {
+                Scratch& scratch = scratch_[t];
+                if (distinct > 0) {
+                    search_(scratch, sources[i], costById, distinct);
+                }
+                table[i].resize(targets.size());
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    table[i][j] = labelOf_(scratch, targets[j]);
+                }
+            }, 1);
+        }
+    };
+}
+
+
+////////////////////////////////////////////////////////////
+// mincostmaxflow.h
+////////////////////////////////////////////////////////////
+#include <cmath>
+
+namespace sgtl{
+    /// Core of fordBellman(): costById(id) gives the cost of edge id, INF means no edge.
+    /// Throws if a negative cycle is reachable from v
+    template <class E, class Weight, template <class> class Store, class CostById>
+    void fordBellmanById_(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, CostById costById, Weight INF) {
+        shortest.assign(g.vertexCount(), INF);
+        shortest[v] = Weight();
+        bool modified = true;
+        size_t passes = 0;
+        while (modified) {
+            if (passes++ == g.vertexCount()) {
+                throw std::runtime_error("fordBellman:: negative cycle");
+            }
+            modified = false;
+            for (vertex v = 0; v < g.vertexCount(); ++v) {
+                if (shortest[v] == INF) {
+                    continue;
+                }
+                for (auto id : g.neighbors(v)) {
+                    Weight c = costById(id);
+                    if ((c != INF) && (shortest[g.to(id)] > shortest[v] + c)) {
+                        shortest[g.to(id)] = shortest[v] + c;
+                        modified = true;
+                    }
+                }
+            }
+        }
+    }
+
+    template <class E, class Weight, template <class> class Store, class Cost>
+    void fordBellman(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF) {
+        fordBellmanById_(g, v, shortest, [&g, &cost](size_t id) -> Weight { return cost(g.edge(id)); }, INF);
+    }
+
+    /// cost[id] is the precomputed cost of edge id
+    template <class E, class Weight, template <class> class Store>
+    void fordBellman(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost,
+                     Weight INF) {
+        fordBellmanById_(g, v, shortest, [&cost](size_t id) { return cost[id]; }, INF);
+    }
+
+    /// Looks for a cycle in the graph of parent edges (parent[u] is the edge id into u); such a cycle
+    /// is always negative. The cycle is written in edge direction
+    template <class E, template <class> class Store>
+    bool parentCycle_(Graph<E, Store>& g, const std::vector<size_t>& parent, std::vector<vertex>& cycle) {
+        const size_t none = std::numeric_limits<size_t>::max();
+        std::vector<size_t> seen(g.vertexCount(), 0);
+        for (vertex s = 0; s < g.vertexCount(); ++s) {
+            vertex u = s;
+            while ((u != NO_VERTEX) && !seen[u]) {
+                seen[u] = s + 1;
+                u = (parent[u] != none) ? g.from(parent[u]) : NO_VERTEX;
+            }
+            if ((u != NO_VERTEX) && (seen[u] == s + 1)) {
+                cycle.clear();
+                vertex x = u;
+                do {
+                    cycle.push_back(x);
+                    x = g.from(parent[x]);
+                } while (x != u);
+                std::reverse(cycle.begin(), cycle.end());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Queue-based Bellman-Ford (SPFA) with small-label-first: a vertex whose label is below the
+    /// label at the head of the deque goes to the front. Every n relaxations the parent graph is
+    /// searched for a cycle, so a reachable negative cycle is found in amortized O(1) per relaxation.
+    /// Returns false and fills cycle if there is one.
+    template <class E, class Weight, template <class> class Store, class CostById>
+    bool spfaById_(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, CostById costById, Weight INF,
+                   std::vector<vertex>& cycle) {
+        size_t n = g.vertexCount();
+        shortest.assign(n, INF);
+        cycle.clear();
+        std::vector<size_t> parent(n, std::numeric_limits<size_t>::max());
+        std::vector<char> queued(n, 0);
+        std::deque<vertex> qq;
+        shortest[v] = Weight();
+        qq.push_back(v);
+        queued[v] = 1;
+        size_t relaxations = 0;
+        while (!qq.empty()) {
+            vertex u = qq.front();
+            qq.pop_front();
+            queued[u] = 0;
+            for (auto id : g.neighbors(u)) {
+                Weight c = costById(id);
+                vertex w = g.to(id);
+                if ((c == INF) || !(shortest[u] + c < shortest[w])) {
+                    continue;
+                }
+                shortest[w] = shortest[u] + c;
+                parent[w] = id;
+                if ((++relaxations % n == 0) && parentCycle_(g, parent, cycle)) {
+                    return false;
+                }
+                if (!queued[w]) {
+                    queued[w] = 1;
+                    if (!qq.empty() && (shortest[w] < shortest[qq.front()])) {
+                        qq.push_front(w);
+                    } else {
+                        qq.push_back(w);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    template <class E, class Weight, template <class> class Store, class Cost>
+    bool spfa(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF,
+              std::vector<vertex>& cycle) {
+        return spfaById_(g, v, shortest, [&g, &cost](size_t id) -> Weight { return cost(g.edge(id)); }, INF, cycle);
+    }
+
+    template <class E, class Weight, template <class> class Store, class Cost>
+    bool spfa(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF) {
+        std::vector<vertex> cycle;
+        return spfa(g, v, shortest, cost, INF, cycle);
+    }
+
+    /// cost[id] is the precomputed cost of edge id
+    template <class E, class Weight, template <class> class Store>
+    bool spfa(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost, Weight INF,
+              std::vector<vertex>& cycle) {
+        return spfaById_(g, v, shortest, [&cost](size_t id) { return cost[id]; }, INF, cycle);
+    }
+
+    template <class E, class Weight, template <class> class Store>
+    bool spfa(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost, Weight INF) {
+        std::vector<vertex> cycle;
+        return spfa(g, v, shortest, cost, INF, cycle);
+    }
+
+    /// Round-based Bellman-Ford on a pool: the vertices improved in one round relax their edges in
+    /// the next, labels are lowered by CAS. Without negative cycles the frontier is empty after
+    /// n rounds, otherwise false is returned (use spfa() to get the cycle itself).
+    template <class E, class Weight, template <class> class Store, class CostById>
+    bool parallelFordBellmanById_(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, CostById costById,
+                                  Weight INF, ThreadPool& pool) {
+        size_t n = g.vertexCount();
+        std::vector<std::atomic<Weight>> label(n);
+        std::vector<std::atomic<size_t>> stamp(n);
+        pool.parallelFor(n, [&](size_t u, size_t) {
+            label[u].store(INF, std::memory_order_relaxed);
+            stamp[u].store(0, std::memory_order_relaxed);
+        }, 4096);
+        label[v].store(Weight());
+        std::vector<std::vector<vertex>> next(pool.size());
+        std::vector<vertex> frontier(1, v);
+        for (size_t round = 1; !frontier.empty(); ++round) {
+            if (round > n) {
+                return false;
+            }
+            pool.parallelFor(frontier.size(), [&](size_t i, size_t t) {
+                vertex u = frontier[i];
+                Weight base = label[u].load(std::memory_order_relaxed);
+                for (auto id : g.neighbors(u)) {
+                    Weight c = costById(id);
+                    if (c == INF) {
+                        continue;
+                    }
+                    vertex w = g.to(id);
+                    Weight candidate = base + c;
+                    Weight current = label[w].load(std::memory_order_relaxed);
+                    bool improved = false;
+                    while (candidate < current) {
+                        if (label[w].compare_exchange_weak(current, candidate)) {
+                            improved = true;
+                            break;
+                        }
+                    }
+                    if (improved && (stamp[w].exchange(round) != round)) {
+                        next[t].push_back(w);
+                    }
+                }
+            }, 64);
+            frontier.clear();
+            for (size_t t = 0; t < next.size(); ++t) {
+                frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+                next[t].clear();
+            }
+        }
+        shortest.resize(n);
+        for (vertex u = 0; u < n; ++u) {
+            shortest[u] = label[u].load(std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    template <class E, class Weight, template <class> class Store, class Cost>
+    bool parallelFordBellman(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, Cost cost, Weight INF,
+                             ThreadPool& pool) {
+        return parallelFordBellmanById_(g, v, shortest, [&g, &cost](size_t id) -> Weight { return cost(g.edge(id)); },
+                                        INF, pool);
+    }
+
+    /// cost[id] is the precomputed cost of edge id
+    template <class E, class Weight, template <class> class Store>
+    bool parallelFordBellman(Graph<E, Store>& g, vertex v, std::vector<Weight> &shortest, const std::vector<Weight>& cost,
+                             Weight INF, ThreadPool& pool) {
+        return parallelFordBellmanById_(g, v, shortest, [&cost](size_t id) { return cost[id]; }, INF, pool);
+    }
+
+    /// Pushes one unit along a shortest path, costById(id) is the reduced cost of edge id
+    template <class EdgeCostFlow, template <class> class Store, class CostById>
+    bool dfsPushMinCostFlow(Network<EdgeCostFlow, Store>& g, vertex v, const std::vector<cost_t>& shortest,
+                            CostById& costById, std::vector<cost_t>& order) {
+        order[v] = 1;
+        if (v == g.getTarget()) {
+            return true;
+        }
+        for (auto id : g.neighbors(v)) {
+            vertex to = g.to(id);
+            if ((g.residualCapacity(id) > 0) && (!order[to])
+                    && (shortest[v] + costById(id) == shortest[to]) ) {
+                if (dfsPushMinCostFlow(g, to, shortest, costById, order)) {
+                    g.pushFlow(id, 1);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    template<class EdgeCostFlow, template <class> class Store, class CostById>
+    void dfsPushMinCostFlow(Network<EdgeCostFlow, Store>& g, const std::vector<cost_t>& shortest,
+                            CostById& costById) {
+        std::vector<cost_t> order(g.vertexCount());
+        dfsPushMinCostFlow(g, g.getSource(), shortest, costById, order);
+    }
+
+    /// Successive shortest paths with Johnson potentials. By default (primal-dual) every Dijkstra
+    /// is followed by a Dinitz max flow over the admissible edges (zero reduced cost), so one phase
+    /// saturates all shortest paths at once; blockingFlow = false pushes one unit per Dijkstra.
+    template<class EdgeCostFlow, template <class> class Store>
+    void minCostMaxFlow(Network<EdgeCostFlow, Store>& g, flow_t& flow, cost_t& cost, cost_t INF,
+                        bool blockingFlow = true) {
+        std::vector<cost_t> p;
+        std::vector<cost_t> shortest;
+        flow = cost = 0;
+        auto costFB = [&g, INF](size_t id) -> cost_t {
+            return (g.residualCapacity(id) > 0) ? g.cost(id) : INF;
+        };
+        std::vector<vertex> cycle;
+        if (!spfaById_(g, g.getSource(), p, costFB, INF, cycle)) {
+            throw std::runtime_error("minCostMaxFlow:: negative cycle");
+        }
+        auto costD = [&g, &p, INF](size_t id) -> cost_t {
+            return (g.residualCapacity(id) > 0) ? p[g.from(id)] - p[g.to(id)] + g.cost(id) : INF;
+        };
+
+        /// Reduced costs are non-negative, so the keys popped by Dijkstra never decrease
+        RadixHeap<cost_t> heap;
+        DinitzSolver<Network<EdgeCostFlow, Store>> dinitz;
+        auto admissible = [&g, &p](size_t id) {
+            return p[g.from(id)] - p[g.to(id)] + g.cost(id) == 0;
+        };
+
+        while (true) {
+            dijkstraById_(g, g.getSource(), shortest, costD, INF, heap);
+            if (shortest[g.getTarget()] == INF) {
+                break;
+            }
+            if (blockingFlow) {
+                cost_t distance = shortest[g.getTarget()];
+                for (vertex v = 0; v < g.vertexCount(); ++v) {
+                    p[v] += std::min(shortest[v], distance);
+                }
+                flow_t pushed = dinitz.run(g, g.getSource(), g.getTarget(), MAX_FLOW, admissible);
+                flow += pushed;
+                cost += pushed * (p[g.getTarget()] - p[g.getSource()]);
+                continue;
+            }
+            dfsPushMinCostFlow(g, shortest, costD);
+            flow += 1;
+            cost += (shortest[g.getTarget()] + p[g.getTarget()] - p[g.getSource()]);
             for (vertex v = 0; v < g.vertexCount(); ++v) {
                 p[v] += (shortest[v] != INF) ? shortest[v] : shortest[g.getTarget()];
             }
@@ -725,12 +3914,661 @@ namespace sgtl{
     }
 }
 
+namespace sgtl {
+    /// Goldberg-Tarjan cost scaling. A maximum flow is found first (Dinitz), then the cheapest
+    /// circulation in its residual network is added by eps-optimal refinements, eps divided by ALPHA
+    /// each time. Costs are multiplied by n + 1 inside, so eps = 1 means optimal. The running time
+    /// depends on n, m and log(max cost), not on the flow value. Negative cycles are cancelled too.
+    /// flow and cost are what was added to the network, as in minCostMaxFlow().
+    template<class Network>
+    class CostScalingSolver {
+    public:
+        static const cost_t ALPHA = 8;
+
+        void run(Network& g, flow_t& flow, cost_t& cost) {
+            size_t n = g.vertexCount();
+            size_t m = g.edgesCount();
+            cost_t before = doubledCost_(g);
+            flow = dinitz_.run(g);
+
+            cost_t scale = n + 1;
+            cost_t eps = 0;
+            scaled_.resize(m);
+            for (size_t id = 0; id < m; ++id) {
+                scaled_[id] = g.cost(id) * scale;
+                eps = std::max(eps, scaled_[id] < 0 ? -scaled_[id] : scaled_[id]);
+            }
+            price_.assign(n, 0);
+            while (eps > 1) {
+                eps = std::max<cost_t>(1, eps / ALPHA);
+                refine_(g, eps);
+            }
+            cost = (doubledCost_(g) - before) / 2;
+        }
+
+        void clear() {
+            dinitz_.clear();
+            std::vector<cost_t>().swap(scaled_);
+            std::vector<cost_t>().swap(price_);
+            std::vector<flow_t>().swap(excess_);
+            std::vector<size_t>().swap(current_);
+            std::vector<vertex>().swap(queue_);
+        }
+
+    private:
+        DinitzSolver<Network> dinitz_;
+        std::vector<cost_t> scaled_;
+        std::vector<cost_t> price_;
+        std::vector<flow_t> excess_;
+        std::vector<size_t> current_;
+        std::vector<vertex> queue_;
+
+        /// Every edge and its back edge both count flow * cost
+        static cost_t doubledCost_(Network& g) {
+            cost_t total = 0;
+            for (size_t id = 0; id < g.edgesCount(); ++id) {
+                total += g.flow(id) * g.cost(id);
+            }
+            return total;
+        }
+
+        cost_t reducedCost_(Network& g, size_t id, vertex v) const {
+            return scaled_[id] + price_[v] - price_[g.to(id)];
+        }
+
+        /// Saturates every residual edge of negative reduced cost, then pushes the excesses
+        /// along admissible edges until none is left
+        void refine_(Network& g, cost_t eps) {
+            size_t n = g.vertexCount();
+            excess_.assign(n, 0);
+            current_.assign(n, 0);
+            queue_.clear();
+            for (vertex v = 0; v < n; ++v) {
+                for (auto id : g.neighbors(v)) {
+                    flow_t residual = g.residualCapacity(id);
+                    if ((residual > 0) && (reducedCost_(g, id, v) < 0)) {
+                        g.pushFlow(id, residual);
+                        excess_[v] -= residual;
+                        excess_[g.to(id)] += residual;
+                    }
+                }
+            }
+            for (vertex v = 0; v < n; ++v) {
+                if (excess_[v] > 0) {
+                    queue_.push_back(v);
+                }
+            }
+            for (size_t head = 0; head < queue_.size(); ++head) {
+                discharge_(g, queue_[head], eps);
+            }
+        }
+
+        void discharge_(Network& g, vertex v, cost_t eps) {
+            auto edges = g.neighbors(v);
+            while (excess_[v] > 0) {
+                if (current_[v] == edges.size()) {
+                    relabel_(g, v, eps);
+                    current_[v] = 0;
+                    continue;
+                }
+                auto id = edges[current_[v]];
+                flow_t residual = g.residualCapacity(id);
+                if ((residual > 0) && (reducedCost_(g, id, v) < 0)) {
+                    vertex w = g.to(id);
+                    flow_t pushed = g.pushFlow(id, std::min(excess_[v], residual));
+                    excess_[v] -= pushed;
+                    bool wasActive = excess_[w] > 0;
+                    excess_[w] += pushed;
+                    if (!wasActive && (excess_[w] > 0)) {
+                        queue_.push_back(w);
+                    }
+                } else {
+                    ++current_[v];
+                }
+            }
+        }
+
+        /// Lowers the price of v just enough to make its cheapest residual edge admissible
+        void relabel_(Network& g, vertex v, cost_t eps) {
+            cost_t best = std::numeric_limits<cost_t>::min();
+            for (auto id : g.neighbors(v)) {
+                if (g.residualCapacity(id) > 0) {
+                    best = std::max(best, price_[g.to(id)] - scaled_[id]);
+                }
+            }
+            price_[v] = best - eps;
+        }
+    };
+
+    template<class EdgeCostFlow, template <class> class Store>
+    void costScalingMinCostMaxFlow(Network<EdgeCostFlow, Store>& g, flow_t& flow, cost_t& cost) {
+        CostScalingSolver<Network<EdgeCostFlow, Store>>().run(g, flow, cost);
+    }
+}
+
+namespace sgtl {
+    /// Primal network simplex with block search pivoting. Works on the edges of the network
+    /// (even ids, flow in [0, capacity]) plus an artificial root joined to every vertex with
+    /// big-M cost. The spanning tree is kept as parent/child/sibling links, so a pivot costs the
+    /// length of the cycle plus the size of the subtree that moves. The result is written back
+    /// into the edges, every old flow is replaced.
+    template<class Network>
+    class NetworkSimplex {
+    public:
+        /// supply[v] > 0 is a source, supply[v] < 0 is a sink. Returns false if the supplies
+        /// can not be routed, the network is not changed then. cost is the total cost of the flow.
+        bool run(Network& g, const std::vector<flow_t>& supply, cost_t& cost) {
+            if (supply.size() != g.vertexCount()) {
+                throw std::runtime_error("NetworkSimplex:: wrong supply size");
+            }
+            flow_t balance = 0;
+            for (auto b : supply) {
+                balance += b;
+            }
+            if (balance != 0) {
+                throw std::runtime_error("NetworkSimplex:: supplies do not sum to zero");
+            }
+            init_(g, supply);
+            size_t entering;
+            while ((entering = findEntering_()) != NONE_) {
+                pivot_(entering);
+            }
+            for (size_t a = edges_; a < arcs_; ++a) {
+                if (flow_[a] > 0) {
+                    return false;
+                }
+            }
+            cost = 0;
+            for (size_t a = 0; a < edges_; ++a) {
+                size_t id = 2 * a;
+                flow_t old = g.flow(id);
+                if (flow_[a] > old) {
+                    g.pushFlow(id, flow_[a] - old);
+                } else if (flow_[a] < old) {
+                    g.pushFlow(id ^ 1, old - flow_[a]);
+                }
+                cost += flow_[a] * cost_[a];
+            }
+            return true;
+        }
+
+        /// Min-cost max-flow from the source to the target. flow and cost are what was added
+        /// to the network, as in minCostMaxFlow().
+        void run(Network& g, flow_t& flow, cost_t& cost) {
+            cost_t before = 0;
+            for (size_t id = 0; id < g.edgesCount(); id += 2) {
+                before += g.flow(id) * g.cost(id);
+            }
+            flow = dinitz_.run(g);
+            std::vector<flow_t> supply(g.vertexCount(), 0);
+            for (auto id : g.neighbors(g.getSource())) {
+                supply[g.getSource()] += g.flow(id);
+            }
+            supply[g.getTarget()] -= supply[g.getSource()];
+            run(g, supply, cost);
+            cost -= before;
+        }
+
+        void clear() {
+            dinitz_.clear();
+            std::vector<vertex>().swap(source_);
+            std::vector<vertex>().swap(target_);
+            std::vector<flow_t>().swap(capacity_);
+            std::vector<flow_t>().swap(flow_);
+            std::vector<cost_t>().swap(cost_);
+            std::vector<signed char>().swap(state_);
+            std::vector<cost_t>().swap(pi_);
+            std::vector<vertex>().swap(parent_);
+            std::vector<size_t>().swap(pred_);
+            std::vector<size_t>().swap(depth_);
+            std::vector<vertex>().swap(child_);
+            std::vector<vertex>().swap(next_);
+            std::vector<vertex>().swap(prev_);
+            std::vector<vertex>().swap(path_);
+        }
+
+    private:
+        static const size_t NONE_ = std::numeric_limits<size_t>::max();
+        enum ArcState { UPPER_ = -1, TREE_ = 0, LOWER_ = 1 };
+
+        DinitzSolver<Network> dinitz_;
+        size_t edges_;
+        size_t arcs_;
+        vertex root_;
+        size_t blockSize_;
+        size_t nextArc_;
+
+        std::vector<vertex> source_;
+        std::vector<vertex> target_;
+        std::vector<flow_t> capacity_;
+        std::vector<flow_t> flow_;
+        std::vector<cost_t> cost_;
+        std::vector<signed char> state_;
+
+        std::vector<cost_t> pi_;
+        std::vector<vertex> parent_;
+        std::vector<size_t> pred_;
+        std::vector<size_t> depth_;
+        std::vector<vertex> child_;
+        std::vector<vertex> next_;
+        std::vector<vertex> prev_;
+        std::vector<vertex> path_;
+
+        void init_(Network& g, const std::vector<flow_t>& supply) {
+            size_t n = g.vertexCount();
+            edges_ = g.edgesCount() / 2;
+            arcs_ = edges_ + n;
+            root_ = checkedCast<vertex>(n, "NetworkSimplex:: too many vertices");
+            source_.resize(arcs_);
+            target_.resize(arcs_);
+            capacity_.resize(arcs_);
+            flow_.assign(arcs_, 0);
+            cost_.resize(arcs_);
+            state_.assign(arcs_, (signed char)LOWER_);
+
+            cost_t maxCost = 0;
+            for (size_t a = 0; a < edges_; ++a) {
+                size_t id = 2 * a;
+                source_[a] = g.from(id);
+                target_[a] = g.to(id);
+                capacity_[a] = g.capacity(id);
+                cost_[a] = g.cost(id);
+                maxCost = std::max(maxCost, cost_[a] < 0 ? -cost_[a] : cost_[a]);
+            }
+
+            /// Any path of the tree holds one artificial arc, so the potentials stay near artificial
+            cost_t artificial = (maxCost + 1) * (cost_t)(n + 1);
+            pi_.assign(n + 1, 0);
+            parent_.assign(n + 1, NO_VERTEX);
+            pred_.assign(n + 1, 0);
+            depth_.assign(n + 1, 1);
+            child_.assign(n + 1, NO_VERTEX);
+            next_.assign(n + 1, NO_VERTEX);
+            prev_.assign(n + 1, NO_VERTEX);
+            depth_[root_] = 0;
+            for (vertex v = 0; v < n; ++v) {
+                size_t a = edges_ + v;
+                capacity_[a] = MAX_FLOW;
+                cost_[a] = artificial;
+                state_[a] = TREE_;
+                if (supply[v] >= 0) {
+                    source_[a] = v;
+                    target_[a] = root_;
+                    flow_[a] = supply[v];
+                    pi_[v] = -artificial;
+                } else {
+                    source_[a] = root_;
+                    target_[a] = v;
+                    flow_[a] = -supply[v];
+                    pi_[v] = artificial;
+                }
+                pred_[v] = a;
+                link_(v, root_);
+            }
+            blockSize_ = std::max<size_t>(10, (size_t)std::sqrt((double)arcs_));
+            nextArc_ = 0;
+        }
+
+        cost_t reducedCost_(size_t a) const {
+            return cost_[a] + pi_[source_[a]] - pi_[target_[a]];
+        }
+
+        /// Scans blocks of arcs from where the last search stopped and takes the most violating
+        /// arc of the first block that has one
+        size_t findEntering_() {
+            size_t best = NONE_;
+            cost_t bestValue = 0;
+            size_t scanned = 0;
+            for (size_t i = 0; i < arcs_; ++i) {
+                size_t a = nextArc_;
+                nextArc_ = (nextArc_ + 1 == arcs_) ? 0 : nextArc_ + 1;
+                cost_t value = state_[a] * reducedCost_(a);
+                if (value < bestValue) {
+                    bestValue = value;
+                    best = a;
+                }
+                if ((++scanned == blockSize_) && (best != NONE_)) {
+                    break;
+                }
+                if (scanned == blockSize_) {
+                    scanned = 0;
+                }
+            }
+            return best;
+        }
+
+        void unlink_(vertex v) {
+            vertex p = parent_[v];
+            if (prev_[v] != NO_VERTEX) {
+                next_[prev_[v]] = next_[v];
+            } else {
+                child_[p] = next_[v];
+            }
+            if (next_[v] != NO_VERTEX) {
+                prev_[next_[v]] = prev_[v];
+            }
+        }
+
+        void link_(vertex v, vertex p) {
+            parent_[v] = p;
+            prev_[v] = NO_VERTEX;
+            next_[v] = child_[p];
+            if (child_[p] != NO_VERTEX) {
+                prev_[child_[p]] = v;
+            }
+            child_[p] = v;
+        }
+
+        /// Residual capacity of the tree arc above v when flow goes down (to v) or up (from v)
+        flow_t treeResidual_(vertex v, bool down) const {
+            size_t a = pred_[v];
+            return ((source_[a] == v) != down) ? capacity_[a] - flow_[a] : flow_[a];
+        }
+
+        void pushTree_(vertex v, bool down, flow_t delta) {
+            size_t a = pred_[v];
+            flow_[a] += ((source_[a] == v) != down) ? delta : -delta;
+        }
+
+        void pivot_(size_t entering) {
+            /// The cycle goes join -> first -> (entering) -> second -> join
+            vertex first = source_[entering];
+            vertex second = target_[entering];
+            if (state_[entering] == UPPER_) {
+                std::swap(first, second);
+            }
+            vertex u = first;
+            vertex w = second;
+            while (u != w) {
+                if (depth_[u] >= depth_[w]) {
+                    u = parent_[u];
+                } else {
+                    w = parent_[w];
+                }
+            }
+            vertex join = u;
+
+            /// Ties go to the last arc of the cycle, which keeps the tree strongly feasible
+            flow_t delta = capacity_[entering];
+            vertex out = NO_VERTEX;
+            bool outFirst = false;
+            for (vertex v = first; v != join; v = parent_[v]) {
+                flow_t residual = treeResidual_(v, true);
+                if (residual < delta) {
+                    delta = residual;
+                    out = v;
+                    outFirst = true;
+                }
+            }
+            for (vertex v = second; v != join; v = parent_[v]) {
+                flow_t residual = treeResidual_(v, false);
+                if (residual <= delta) {
+                    delta = residual;
+                    out = v;
+                    outFirst = false;
+                }
+            }
+
+            if (delta > 0) {
+                flow_[entering] += state_[entering] * delta;
+                for (vertex v = first; v != join; v = parent_[v]) {
+                    pushTree_(v, true, delta);
+                }
+                for (vertex v = second; v != join; v = parent_[v]) {
+                    pushTree_(v, false, delta);
+                }
+            }
+            if (out == NO_VERTEX) {
+                state_[entering] = -state_[entering];
+                return;
+            }
+
+            size_t leaving = pred_[out];
+            state_[leaving] = (flow_[leaving] == 0) ? LOWER_ : UPPER_;
+            state_[entering] = TREE_;
+
+            /// The subtree under the leaving arc is hung by the entering arc, reversing the path
+            /// from its endpoint x up to out
+            vertex x = outFirst ? first : second;
+            vertex y = outFirst ? second : first;
+            cost_t sigma = (x == target_[entering]) ? reducedCost_(entering) : -reducedCost_(entering);
+            path_.clear();
+            for (vertex v = x; ; v = parent_[v]) {
+                path_.push_back(v);
+                unlink_(v);
+                if (v == out) {
+                    break;
+                }
+            }
+            for (size_t i = path_.size() - 1; i > 0; --i) {
+                pred_[path_[i]] = pred_[path_[i - 1]];
+                link_(path_[i], path_[i - 1]);
+            }
+            pred_[x] = entering;
+            link_(x, y);
+
+            /// Depths and potentials of the moved subtree, preorder with the path_ as a stack
+            path_.clear();
+            depth_[x] = depth_[y] + 1;
+            pi_[x] += sigma;
+            path_.push_back(x);
+            while (!path_.empty()) {
+                vertex v = path_.back();
+                path_.pop_back();
+                for (vertex c = child_[v]; c != NO_VERTEX; c = next_[c]) {
+                    depth_[c] = depth_[v] + 1;
+                    pi_[c] += sigma;
+                    path_.push_back(c);
+                }
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////
+// matching.h
+////////////////////////////////////////////////////////////
+
+namespace sgtl {
+    /// Hopcroft-Karp maximum matching between left vertices [0, left) and right vertices [0, right),
+    /// O(E sqrt(V)). Every phase is a BFS from the free left vertices that layers the graph up to the
+    /// nearest free right vertex and an iterative DFS with current-arc pointers that takes a maximal
+    /// set of shortest augmenting paths.
+    /// The last BFS finds no free right vertex and marks exactly the vertices reachable by alternating
+    /// paths (Z), which gives the Konig vertex cover (L \ Z) + (R & Z) and its complement,
+    /// the maximum independent set.
+    class BipartiteMatching {
+    public:
+        BipartiteMatching(size_t left, size_t right)
+            : left_(checkedCast<vertex>(left, "BipartiteMatching:: too many vertices")),
+              right_(checkedCast<vertex>(right, "BipartiteMatching:: too many vertices")), size_(0) {
+        }
+
+        void pushEdge(vertex u, vertex v) {
+            if ((u >= left_) || (v >= right_)) {
+                throw std::runtime_error("BipartiteMatching:: vertex out of bounds");
+            }
+            edges_.push_back(std::make_pair(u, v));
+        }
+
+        /// Returns the size of a maximum matching, starting from the current one
+        size_t run() {
+            build_();
+            while (bfs_()) {
+                for (vertex u = 0; u < left_; ++u) {
+                    if ((matchLeft_[u] == NO_VERTEX) && augment_(u)) {
+                        ++size_;
+                    }
+                }
+            }
+            return size_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        /// Right mate of left vertex u, NO_VERTEX if u is free
+        vertex mateOfLeft(vertex u) const {
+            return matchLeft_.at(u);
+        }
+
+        /// Left mate of right vertex v, NO_VERTEX if v is free
+        vertex mateOfRight(vertex v) const {
+            return matchRight_.at(v);
+        }
+
+        /// Minimum vertex cover, as many vertices as the matching has edges
+        void minVertexCover(std::vector<vertex>& left, std::vector<vertex>& right) const {
+            collect_(left, right, true);
+        }
+
+        /// Maximum independent set, the complement of the cover
+        void maxIndependentSet(std::vector<vertex>& left, std::vector<vertex>& right) const {
+            collect_(left, right, false);
+        }
+
+    private:
+        vertex left_;
+        vertex right_;
+        size_t size_;
+        std::vector<std::pair<vertex, vertex>> edges_;
+        std::vector<size_t> start_;
+        std::vector<vertex> adjacent_;
+        std::vector<vertex> matchLeft_;
+        std::vector<vertex> matchRight_;
+        std::vector<size_t> level_;         /// BFS layer of a left vertex, NO_LEVEL_ if unreached
+        size_t freeLevel_;                  /// layer of the first left vertex next to a free right one
+        std::vector<char> reachedRight_;
+        std::vector<size_t> current_;
+        std::vector<vertex> queue_;
+        std::vector<vertex> stack_;
+
+        static const size_t NO_LEVEL_ = std::numeric_limits<size_t>::max();
+
+        /// Adjacency in CSR form; the matching found so far is kept
+        void build_() {
+            start_.assign(left_ + 1, 0);
+            for (auto& e : edges_) {
+                ++start_[e.first + 1];
+            }
+            for (vertex u = 0; u < left_; ++u) {
+                start_[u + 1] += start_[u];
+            }
+            adjacent_.resize(edges_.size());
+            std::vector<size_t> next(start_.begin(), start_.end() - 1);
+            for (auto& e : edges_) {
+                adjacent_[next[e.first]++] = e.second;
+            }
+            matchLeft_.resize(left_, NO_VERTEX);
+            matchRight_.resize(right_, NO_VERTEX);
+            level_.resize(left_);
+            reachedRight_.resize(right_);
+            current_.resize(left_);
+        }
+
+        /// Layers the left vertices by alternating distance from the free ones, up to the first layer
+        /// next to a free right vertex, so a phase takes only shortest augmenting paths.
+        /// True if some free right vertex is reachable; otherwise the BFS went through the whole
+        /// alternating reachability, which is the Z of the Konig cover
+        bool bfs_() {
+            queue_.clear();
+            for (vertex u = 0; u < left_; ++u) {
+                if (matchLeft_[u] == NO_VERTEX) {
+                    level_[u] = 0;
+                    queue_.push_back(u);
+                } else {
+                    level_[u] = NO_LEVEL_;
+                }
+            }
+            std::fill(reachedRight_.begin(), reachedRight_.end(), 0);
+            freeLevel_ = NO_LEVEL_;
+            for (size_t head = 0; head < queue_.size(); ++head) {
+                vertex u = queue_[head];
+                if (level_[u] > freeLevel_) {
+                    break;
+                }
+                for (size_t i = start_[u]; i < start_[u + 1]; ++i) {
+                    vertex v = adjacent_[i];
+                    if (reachedRight_[v]) {
+                        continue;
+                    }
+                    reachedRight_[v] = 1;
+                    vertex w = matchRight_[v];
+                    if (w == NO_VERTEX) {
+                        freeLevel_ = std::min(freeLevel_, level_[u]);
+                    } else if (level_[w] == NO_LEVEL_) {
+                        level_[w] = level_[u] + 1;
+                        queue_.push_back(w);
+                    }
+                }
+            }
+            for (vertex u = 0; u < left_; ++u) {
+                current_[u] = start_[u];
+            }
+            return freeLevel_ != NO_LEVEL_;
+        }
+
+        /// Iterative DFS along the layers from free left vertex u, a path may end only at the layer
+        /// of freeLevel_; a dead end is cut off by dropping its level, so every edge is tried once per phase
+        bool augment_(vertex u) {
+            stack_.assign(1, u);
+            while (!stack_.empty()) {
+                vertex x = stack_.back();
+                if (current_[x] == start_[x + 1]) {
+                    level_[x] = NO_LEVEL_;
+                    stack_.pop_back();
+                    if (!stack_.empty()) {
+                        ++current_[stack_.back()];
+                    }
+                    continue;
+                }
+                vertex v = adjacent_[current_[x]];
+                vertex w = matchRight_[v];
+                if ((w == NO_VERTEX) && (level_[x] == freeLevel_)) {
+                    for (auto y : stack_) {
+                        vertex mate = adjacent_[current_[y]];
+                        matchLeft_[y] = mate;
+                        matchRight_[mate] = y;
+                    }
+                    return true;
+                }
+                if ((w != NO_VERTEX) && (level_[x] < freeLevel_) && (level_[w] == level_[x] + 1)) {
+                    stack_.push_back(w);
+                } else {
+                    ++current_[x];
+                }
+            }
+            return false;
+        }
+
+        void collect_(std::vector<vertex>& left, std::vector<vertex>& right, bool cover) const {
+            if (level_.size() != left_) {
+                throw std::runtime_error("BipartiteMatching:: run() was not called");
+            }
+            left.clear();
+            right.clear();
+            for (vertex u = 0; u < left_; ++u) {
+                if ((level_[u] == NO_LEVEL_) == cover) {
+                    left.push_back(u);
+                }
+            }
+            for (vertex v = 0; v < right_; ++v) {
+                if ((reachedRight_[v] != 0) == cover) {
+                    right.push_back(v);
+                }
+            }
+        }
+    };
+}
+
+
 ////////////////////////////////////////////////////////////
 // RAW
 ////////////////////////////////////////////////////////////
 
-template<class E>
-void dfsDecompose01Flow(sgtl::Network<E>& g, std::vector<E>& ans, sgtl::vertex v) {
+template<class E, template <class> class Store>
+void dfsDecompose01Flow(sgtl::Network<E, Store>& g, std::vector<E>& ans, sgtl::vertex v) {
     for (auto e = g.begin(v); e != g.end(v); ++e) {
         if (!(*e).unsaturated() && ((*e).mark > 0) && ((*e).capacity() > 0)) {
             e.mark(0 - (*e).mark);
@@ -741,8 +4579,8 @@ void dfsDecompose01Flow(sgtl::Network<E>& g, std::vector<E>& ans, sgtl::vertex v
     }
 }
 
-template<class E>
-std::vector<std::vector<E>> decompose01Flow(sgtl::Network<E>& g) {
+template<class E, template <class> class Store>
+std::vector<std::vector<E>> decompose01Flow(sgtl::Network<E, Store>& g) {
     std::vector<std::vector<E>> ans;
     for (auto e = g.begin(g.getSource()); e != g.end(g.getSource()); ++e) {
         if (!(*e).unsaturated() && ((*e).mark > 0) && ((*e).capacity() > 0)) {
@@ -756,9 +4594,9 @@ std::vector<std::vector<E>> decompose01Flow(sgtl::Network<E>& g) {
 }
 
 
-template<class E>
-std::vector<sgtl::vertex> getMaxIndependent(sgtl::Network<E>& g, int n) {
-    sgtl::Dinitz<sgtl::Network<E>>::getMaxFlow(g);
+template<class E, template <class> class Store>
+std::vector<sgtl::vertex> getMaxIndependent(sgtl::Network<E, Store>& g, int n) {
+    sgtl::Dinitz<sgtl::Network<E, Store>>::getMaxFlow(g);
     std::vector<sgtl::vertex> order;
     sgtl::BFS::bfsUntil(g, g.getSource(), g.getTarget(), order);
     std::vector<int> mGuests, nGuests;